@@ -0,0 +1,100 @@
+#version 450 core
+
+layout (location = 0) in vec2  a_gridPos;          // lattice coordinates, unused with u_vertexFromId
+layout (location = 1) in vec3  a_tileOffsetScale;  // per instance: world xz of the node corner, world units per lattice step
+layout (location = 2) in uvec2 a_tileLevelRotation; // per instance: lod, unused rotation
+
+// Per-frame camera data shared by every terrain program, FrameUniforms in main.cpp
+layout (std140, binding = 0) uniform FrameUniforms
+{
+    mat4  u_projMatrix;
+    mat4  u_viewMatrix;
+    vec3  u_cameraPos;
+    float u_projScale; // pixels spanned by a unit size at unit distance
+    vec2  u_samplerDim;
+    int   u_finestLevel; // finest clipmap level resident under the footprint, coarser ones all are
+    vec4  u_frustumPlanes[6];
+};
+
+uniform int  u_latticeWidth;
+uniform bool u_vertexFromId; // derive lattice coordinates from the vertex index
+uniform int  u_levelCount;
+
+// Distances over which lod L morphs into lod L + 1
+uniform float u_morphStart[16];
+uniform float u_morphEnd[16];
+
+// One toroidally addressed layer per clipmap level, lod L samples level L
+uniform sampler2DArray u_clipmap;
+uniform sampler2DArray u_clipmapNormals; // xz of the unit normal, y is rebuilt
+uniform int  u_clipmapDim;
+uniform float u_heightScale;
+
+out float v_height;
+out vec3  v_normal;
+out vec2  v_uv;
+
+ivec3 clipmapTexel(ivec2 texel, int level)
+{
+    return ivec3(texel & (u_clipmapDim - 1), level);
+}
+
+// Bilinear height and normal of one level, the clipmap itself is nearest filtered
+void sampleLevel(vec2 xz, int level, out float height, out vec2 normalXZ)
+{
+    vec2 texel = xz / exp2(float(level));
+    ivec2 t0 = ivec2(floor(texel));
+    vec2 f = texel - vec2(t0);
+
+    ivec3 t00 = clipmapTexel(t0, level);
+    ivec3 t10 = clipmapTexel(t0 + ivec2(1, 0), level);
+    ivec3 t01 = clipmapTexel(t0 + ivec2(0, 1), level);
+    ivec3 t11 = clipmapTexel(t0 + ivec2(1, 1), level);
+
+    height = mix(mix(texelFetch(u_clipmap, t00, 0).x, texelFetch(u_clipmap, t10, 0).x, f.x),
+                 mix(texelFetch(u_clipmap, t01, 0).x, texelFetch(u_clipmap, t11, 0).x, f.x), f.y);
+    normalXZ = mix(mix(texelFetch(u_clipmapNormals, t00, 0).xy, texelFetch(u_clipmapNormals, t10, 0).xy, f.x),
+                   mix(texelFetch(u_clipmapNormals, t01, 0).xy, texelFetch(u_clipmapNormals, t11, 0).xy, f.x), f.y);
+}
+
+void main()
+{
+    vec2 gridPos = u_vertexFromId ? vec2(gl_VertexID % u_latticeWidth, gl_VertexID / u_latticeWidth) : a_gridPos;
+    int lod = int(a_tileLevelRotation.x);
+    float spacing = a_tileOffsetScale.z;
+    vec2 worldXZ = a_tileOffsetScale.xy + gridPos * spacing;
+
+    // Lods finer than the finest resident level sample that level instead, and
+    // so does their morph target; the morph stays a no-op until the lod is resident
+    int level = max(lod, u_finestLevel);
+    int coarseLevel = max(lod + 1, u_finestLevel);
+
+    // Morph factor from the distance to the unmorphed vertex
+    float height;
+    vec2 normalXZ;
+    sampleLevel(worldXZ, level, height, normalXZ);
+    float dist = distance(u_cameraPos, vec3(worldXZ.x, height * u_heightScale, worldXZ.y));
+    float k = lod + 1 < u_levelCount ?
+        clamp((dist - u_morphStart[lod]) / (u_morphEnd[lod] - u_morphStart[lod]), 0.0f, 1.0f) : 0.0f;
+
+    // Odd vertices slide onto the next lod's grid, its heights reached at k = 1
+    // match the coarser neighbour's vertices exactly
+    vec2 morphedXZ = a_tileOffsetScale.xy + (gridPos - fract(gridPos * 0.5f) * 2.0f * k) * spacing;
+
+    sampleLevel(morphedXZ, level, height, normalXZ);
+    if (k > 0.0f)
+    {
+        float coarseHeight;
+        vec2 coarseNormalXZ;
+        sampleLevel(morphedXZ, coarseLevel, coarseHeight, coarseNormalXZ);
+        height = mix(height, coarseHeight, k);
+        normalXZ = mix(normalXZ, coarseNormalXZ, k);
+    }
+
+    vec3 worldPos = vec3(morphedXZ.x, height * u_heightScale, morphedXZ.y);
+    v_normal = vec3(normalXZ.x, sqrt(max(1.0f - dot(normalXZ, normalXZ), 0.0f)), normalXZ.y);
+    v_height = height;
+    v_uv = vec2(worldPos.x / u_samplerDim.x, worldPos.z / u_samplerDim.y);
+
+    gl_Position = u_projMatrix * u_viewMatrix * vec4(worldPos, 1.0f);
+}
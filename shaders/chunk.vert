@@ -0,0 +1,73 @@
+#version 450 core
+
+layout (location = 0) in vec2  a_samplePos; // chunk-local sample coordinates of a baked vertex
+layout (location = 1) in vec4  a_chunk;     // per instance: world xz of the chunk corner, world units per grid step, skirt height
+layout (location = 2) in float a_height;    // baked normalized height
+layout (location = 3) in vec2  a_gradient;  // baked normalized rise per sample
+
+// Per-frame camera data shared by every terrain program, FrameUniforms in main.cpp
+layout (std140, binding = 0) uniform FrameUniforms
+{
+    mat4  u_projMatrix;
+    mat4  u_viewMatrix;
+    vec3  u_cameraPos;
+    float u_projScale; // pixels spanned by a unit size at unit distance
+    vec2  u_samplerDim;
+    int   u_finestLevel; // finest clipmap level resident under the footprint, coarser ones all are
+    vec4  u_frustumPlanes[6];
+};
+
+// Regular grid over the chunk from gl_VertexID, sampling the clipmap level of
+// its step, instead of baked vertices
+uniform bool u_clipmapGrid;
+uniform int  u_chunkSize;
+uniform int  u_gridWidth; // lattice width of the grid indices, one skirt vertex past either side
+
+// One toroidally addressed layer per clipmap level
+uniform sampler2DArray u_clipmap;
+uniform sampler2DArray u_clipmapNormals; // xz of the unit normal, y is rebuilt
+uniform int  u_clipmapDim;
+uniform float u_heightScale;
+
+out float v_height;
+out vec3  v_normal;
+out vec2  v_uv;
+
+ivec3 clipmapTexel(ivec2 texel, int level)
+{
+    return ivec3(texel & (u_clipmapDim - 1), level);
+}
+
+void main()
+{
+    vec2 xz;
+    float height;
+    vec2 normalXZ;
+
+    if (u_clipmapGrid)
+    {
+        // The outermost ring of the lattice repeats the border as a skirt
+        int level = findMSB(uint(a_chunk.z));
+        int quads = u_chunkSize >> level;
+        ivec2 lattice = ivec2(gl_VertexID % u_gridWidth, gl_VertexID / u_gridWidth) - 1;
+        ivec2 gridPos = clamp(lattice, ivec2(0), ivec2(quads));
+
+        ivec3 texel = clipmapTexel((ivec2(a_chunk.xy) >> level) + gridPos, level);
+        xz = a_chunk.xy + vec2(gridPos) * a_chunk.z;
+        height = lattice == gridPos ? texelFetch(u_clipmap, texel, 0).x : a_chunk.w;
+        normalXZ = texelFetch(u_clipmapNormals, texel, 0).xy;
+    }
+    else
+    {
+        xz = a_chunk.xy + a_samplePos;
+        height = a_height;
+        normalXZ = normalize(vec3(-a_gradient.x * u_heightScale, 1.0f, -a_gradient.y * u_heightScale)).xz;
+    }
+
+    vec3 worldPos = vec3(xz.x, height * u_heightScale, xz.y);
+    v_normal = vec3(normalXZ.x, sqrt(max(1.0f - dot(normalXZ, normalXZ), 0.0f)), normalXZ.y);
+    v_height = height;
+    v_uv = vec2(worldPos.x / u_samplerDim.x, worldPos.z / u_samplerDim.y);
+
+    gl_Position = u_projMatrix * u_viewMatrix * vec4(worldPos, 1.0f);
+}
@@ -1,12 +1,16 @@
 #version 450 core
 
 in float v_height;
+in vec3  v_normal;
 in vec2  v_uv;
 
 out vec4 o_color;
 
+const vec3 c_sunDir = normalize(vec3(0.4, 0.8, 0.3));
+
 void main(void)
 {
 	// o_color = vec4(v_uv, 0.0, 1.0); // texture2D(tex_terrain,vs_tex_coord);
-	o_color = vec4(vec3(abs(v_height)), 1.0); // texture2D(tex_terrain,vs_tex_coord);
+	float diffuse = max(dot(normalize(v_normal), c_sunDir), 0.0) * 0.8 + 0.2;
+	o_color = vec4(vec3(abs(v_height)) * diffuse, 1.0); // texture2D(tex_terrain,vs_tex_coord);
 }
\ No newline at end of file
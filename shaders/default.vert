@@ -1,26 +1,127 @@
 #version 450 core
 
-layout (location = 0) in vec3 a_pos;
+layout (location = 0) in vec2  a_gridPos;          // lattice coordinates, unused with u_vertexFromId
+layout (location = 1) in vec3  a_tileOffsetScale;  // per instance: world xz offset, world units per lattice step
+layout (location = 2) in uvec2 a_tileLevelRotation; // per instance: clipmap level, counter-clockwise quarter turns
 
-uniform mat4 u_projMatrix;
-uniform mat4 u_viewMatrix;
-uniform mat4 u_modelMatrix;
+// Per-frame camera data shared by every terrain program, FrameUniforms in main.cpp
+layout (std140, binding = 0) uniform FrameUniforms
+{
+    mat4  u_projMatrix;
+    mat4  u_viewMatrix;
+    vec3  u_cameraPos;
+    float u_projScale; // pixels spanned by a unit size at unit distance
+    vec2  u_samplerDim;
+    int   u_finestLevel; // finest clipmap level resident under the footprint, coarser ones all are
+    vec4  u_frustumPlanes[6];
+};
+
+uniform int  u_tileDim;
+uniform int  u_latticeWidth;
+uniform bool u_vertexFromId; // derive lattice coordinates from the vertex index
+uniform int  u_levelCount;
 
-uniform sampler2D u_heightMap;
-uniform vec2 u_samplerDim;
+// One toroidally addressed layer per clipmap level
+uniform sampler2DArray u_clipmap;
+uniform sampler2DArray u_clipmapNormals; // xz of the unit normal, y is rebuilt
+uniform int  u_clipmapDim;
+uniform float u_heightScale;
 
 out float v_height;
+out vec3  v_normal;
 out vec2  v_uv;
 
+vec2 rotateQuarterTurns(vec2 p, uint rotation)
+{
+    switch (rotation & 3u)
+    {
+        case 1u: return vec2(-p.y,  p.x);
+        case 2u: return vec2(-p.x, -p.y);
+        case 3u: return vec2( p.y, -p.x);
+        default: return p;
+    }
+}
+
+ivec3 clipmapTexel(ivec2 texel, int level)
+{
+    return ivec3(texel & (u_clipmapDim - 1), level);
+}
+
+// Bilinear height and normal of one level, the clipmap itself is nearest filtered
+void sampleLevel(vec2 xz, int level, out float height, out vec2 normalXZ)
+{
+    vec2 texel = xz / exp2(float(level));
+    ivec2 t0 = ivec2(floor(texel));
+    vec2 f = texel - vec2(t0);
+
+    ivec3 t00 = clipmapTexel(t0, level);
+    ivec3 t10 = clipmapTexel(t0 + ivec2(1, 0), level);
+    ivec3 t01 = clipmapTexel(t0 + ivec2(0, 1), level);
+    ivec3 t11 = clipmapTexel(t0 + ivec2(1, 1), level);
+
+    height = mix(mix(texelFetch(u_clipmap, t00, 0).x, texelFetch(u_clipmap, t10, 0).x, f.x),
+                 mix(texelFetch(u_clipmap, t01, 0).x, texelFetch(u_clipmap, t11, 0).x, f.x), f.y);
+    normalXZ = mix(mix(texelFetch(u_clipmapNormals, t00, 0).xy, texelFetch(u_clipmapNormals, t10, 0).xy, f.x),
+                   mix(texelFetch(u_clipmapNormals, t01, 0).xy, texelFetch(u_clipmapNormals, t11, 0).xy, f.x), f.y);
+}
+
 void main()
 {
-    vec3 worldPos = (u_modelMatrix * vec4(a_pos, 1.0f)).xyz;
+    vec2 gridPos = u_vertexFromId ? vec2(gl_VertexID % u_latticeWidth, gl_VertexID / u_latticeWidth) : a_gridPos;
+    int level = int(a_tileLevelRotation.x);
+    float spacing = a_tileOffsetScale.z;
+    vec2 worldXZ = a_tileOffsetScale.xy + rotateQuarterTurns(gridPos, a_tileLevelRotation.y) * spacing;
+    vec3 worldPos = vec3(worldXZ.x, 0.0f, worldXZ.y);
     vec2 uv = vec2( worldPos.x / u_samplerDim.x, worldPos.z / u_samplerDim.y );
-    float height = texelFetch(u_heightMap, ivec2(worldPos.x, worldPos.z), 0).x;
-    worldPos.y += height * 50.0f;
 
+    // Layout vertices of level L sit on its 2^L grid, wrap into the level's window
+    ivec2 texel = ivec2(round(worldXZ / spacing));
+    float height;
+    vec2 normalXZ;
+    float alpha = 0.0f;
+
+    if (level < u_finestLevel)
+    {
+        // Level still streaming in, interpolate the finest resident one. Its
+        // ring's inner border does not morph, so the two still meet exactly
+        sampleLevel(worldXZ, u_finestLevel, height, normalXZ);
+    }
+    else
+    {
+        height = texelFetch(u_clipmap, clipmapTexel(texel, level), 0).x;
+        normalXZ = texelFetch(u_clipmapNormals, clipmapTexel(texel, level), 0).xy;
+
+        // Morph towards level L + 1 over the outer part of the level, so vertices
+        // on the border of the coarser level's hole match it exactly
+        float width = 0.4f * float(u_tileDim) * spacing;
+        vec2 cameraOffset = abs(worldXZ - u_cameraPos.xz);
+        alpha = level + 1 < u_levelCount ?
+            clamp((max(cameraOffset.x, cameraOffset.y) - (2.0f * float(u_tileDim) * spacing - width)) / width, 0.0f, 1.0f) : 0.0f;
+    }
+
+    if (alpha > 0.0f)
+    {
+        // Odd texels fall between coarse ones, take the coarse edge midpoint
+        ivec2 c0 = texel >> 1;
+        ivec2 c1 = (texel + 1) >> 1;
+        ivec3 t00 = clipmapTexel(c0, level + 1);
+        ivec3 t10 = clipmapTexel(ivec2(c1.x, c0.y), level + 1);
+        ivec3 t01 = clipmapTexel(ivec2(c0.x, c1.y), level + 1);
+        ivec3 t11 = clipmapTexel(c1, level + 1);
+
+        float coarseHeight = 0.25f * (texelFetch(u_clipmap, t00, 0).x + texelFetch(u_clipmap, t10, 0).x +
+                                      texelFetch(u_clipmap, t01, 0).x + texelFetch(u_clipmap, t11, 0).x);
+        vec2 coarseNormalXZ = 0.25f * (texelFetch(u_clipmapNormals, t00, 0).xy + texelFetch(u_clipmapNormals, t10, 0).xy +
+                                       texelFetch(u_clipmapNormals, t01, 0).xy + texelFetch(u_clipmapNormals, t11, 0).xy);
+
+        height = mix(height, coarseHeight, alpha);
+        normalXZ = mix(normalXZ, coarseNormalXZ, alpha);
+    }
+
+    worldPos.y += height * u_heightScale;
+    v_normal = vec3(normalXZ.x, sqrt(max(1.0f - dot(normalXZ, normalXZ), 0.0f)), normalXZ.y);
 
     gl_Position = u_projMatrix * u_viewMatrix * vec4(worldPos, 1.0f);
     v_height = height;
     v_uv = uv;
-}
\ No newline at end of file
+}
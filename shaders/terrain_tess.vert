@@ -0,0 +1,11 @@
+#version 450 core
+
+layout (location = 0) in vec2 a_position;    // world xz of a patch corner
+layout (location = 1) in vec2 a_heightRange; // world height range of the patches sharing the corner
+
+out vec4 v_corner;
+
+void main()
+{
+    v_corner = vec4(a_position, a_heightRange);
+}
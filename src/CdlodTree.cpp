@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "CdlodTree.hpp"
+#include "Defines.hpp"
+
+void CdlodSelection::clear()
+{
+    nodes.clear();
+    quarters.clear();
+    visitedNodes = 0u;
+}
+
+// Whether any point of the box lies within radius of the center
+static bool intersectsSphere(const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& center, float radius)
+{
+    const glm::vec3 nearest = glm::clamp(center, lo, hi);
+    const glm::vec3 d = nearest - center;
+    return glm::dot(d, d) <= radius * radius;
+}
+
+void CdlodTree::create(const CdlodSettings& treeSettings, uint32_t mapWidth, uint32_t mapHeight)
+{
+    if (treeSettings.lodCount == 0u || treeSettings.lodCount > MAX_LODS || (treeSettings.nodeDim & 3u))
+        EXIT("CDLOD needs 1 to " + std::to_string(MAX_LODS) + " lods and a node dimension divisible by 4");
+
+    settings = treeSettings;
+
+    const uint32_t rootSize = settings.nodeDim << (settings.lodCount - 1u);
+    rootsX = (mapWidth + rootSize - 1u) / rootSize;
+    rootsY = (mapHeight + rootSize - 1u) / rootSize;
+
+    // Morphing finishes at the end of a lod's range, where the next lod takes over
+    for (uint32_t lod = 0u; lod < settings.lodCount; ++lod)
+    {
+        ranges[lod] = settings.lodRange0 * static_cast<float>(1u << lod);
+        const float previous = lod > 0u ? ranges[lod - 1u] : 0.0f;
+        morphStarts[lod] = ranges[lod] - settings.morphFraction * (ranges[lod] - previous);
+    }
+}
+
+bool CdlodTree::selectNode(const MinMaxTree& bounds, const Frustum& frustum, const glm::vec3& cameraPos,
+                           uint32_t x, uint32_t y, uint32_t lod, bool asQuarter, CdlodSelection& selection) const
+{
+    ++selection.visitedNodes;
+
+    // Vertices sample bilinearly and morph towards the next lod, padding covers both
+    const uint32_t size = settings.nodeDim << lod;
+    const int32_t pad = 4 << lod;
+    const int32_t x0 = static_cast<int32_t>(x * size);
+    const int32_t y0 = static_cast<int32_t>(y * size);
+    const HeightRange range = bounds.query(x0 - pad, y0 - pad, x0 + static_cast<int32_t>(size) + pad,
+                                           y0 + static_cast<int32_t>(size) + pad);
+
+    const glm::vec3 lo { float(x0), range.min * settings.heightScale, float(y0) };
+    const glm::vec3 hi { float(x0 + size), range.max * settings.heightScale, float(y0 + size) };
+
+    // Nothing to draw either way
+    if (!intersectsAabb(frustum, lo, hi))
+        return true;
+
+    if (!intersectsSphere(lo, hi, cameraPos, ranges[lod]))
+    {
+        if (asQuarter)
+            selection.quarters.push_back({ { lo.x, lo.z }, float(2u << lod), static_cast<uint16_t>(lod + 1u), 0u });
+        return asQuarter;
+    }
+
+    if (lod == 0u || !intersectsSphere(lo, hi, cameraPos, ranges[lod - 1u]))
+    {
+        selection.nodes.push_back({ { lo.x, lo.z }, float(1u << lod), static_cast<uint16_t>(lod), 0u });
+        return true;
+    }
+
+    for (uint32_t child = 0u; child < 4u; ++child)
+        selectNode(bounds, frustum, cameraPos, 2u * x + (child & 1u), 2u * y + (child >> 1u), lod - 1u, true, selection);
+    return true;
+}
+
+void CdlodTree::select(const MinMaxTree& bounds, const Frustum& frustum, const glm::vec3& cameraPos,
+                       CdlodSelection& selection)
+{
+    selection.clear();
+
+    // Single-threaded on purpose: frustum and range culling keep a selection to
+    // a few hundred visited nodes, tens of microseconds even for 256 roots, less
+    // than spawning a thread would cost while the decode workers hold the other cores
+    const uint32_t rootLod = settings.lodCount - 1u;
+    for (uint32_t y = 0u; y < rootsY; ++y)
+        for (uint32_t x = 0u; x < rootsX; ++x)
+            selectNode(bounds, frustum, cameraPos, x, y, rootLod, false, selection);
+}
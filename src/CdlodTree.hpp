@@ -0,0 +1,70 @@
+#ifndef CDLOD_TREE_HPP
+#define CDLOD_TREE_HPP
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ClipmapLayout.hpp"
+#include "Frustum.hpp"
+#include "MinMaxTree.hpp"
+
+struct CdlodSettings {
+    uint32_t nodeDim;       // quads per side of a node's grid, a multiple of 4 so quarters stay on even vertices
+    uint32_t lodCount;      // lod 0 has a vertex spacing of 1, every further one doubles it
+    float    lodRange0;     // selection range of lod 0, doubling per lod
+    float    morphFraction; // outer part of every lod's range over which vertices morph to the next lod
+    float    heightScale;   // world height of a normalized bound
+};
+
+// Instances of one frame, offset at the node corner and scale the vertex spacing
+struct CdlodSelection {
+    std::vector<TileInstance> nodes;    // nodeDim x nodeDim quads
+    std::vector<TileInstance> quarters; // nodeDim/2 x nodeDim/2 quads, a quarter of a node at its parent's lod
+    uint32_t visitedNodes = 0u;
+
+    void clear();
+};
+
+/**
+ * @brief Continuous distance-dependent LOD (Strugar 2009) over a heightmap. A
+ * node of lod L spans nodeDim << L samples, the roots sit at the last lod and
+ * tile the map. A node in range of its own lod but not of the next finer one is
+ * drawn whole; otherwise its children are visited, and those beyond their range
+ * are drawn as quarters of it. Height bounds come from the min/max tree, so flat
+ * areas stop subdividing where rough ones continue.
+ */
+class CdlodTree
+{
+public:
+    static constexpr uint32_t MAX_LODS = 16u;
+
+private:
+    CdlodSettings settings {};
+    uint32_t rootsX = 0u;
+    uint32_t rootsY = 0u;
+    float ranges[MAX_LODS] {};
+    float morphStarts[MAX_LODS] {};
+
+    bool selectNode(const MinMaxTree& bounds, const Frustum& frustum, const glm::vec3& cameraPos,
+                    uint32_t x, uint32_t y, uint32_t lod, bool asQuarter, CdlodSelection& selection) const;
+
+public:
+    void create(const CdlodSettings& settings, uint32_t mapWidth, uint32_t mapHeight);
+
+    // Selects the frustum's nodes around the camera on the calling thread
+    void select(const MinMaxTree& bounds, const Frustum& frustum, const glm::vec3& cameraPos, CdlodSelection& selection);
+
+    uint32_t getRootCount() const { return rootsX * rootsY; }
+    // Nodes plus quarters a selection can hold, each spans at least nodeDim samples of a root
+    size_t getMaxSelectionSize() const
+    {
+        const size_t leaves = size_t(1u) << (settings.lodCount - 1u);
+        return size_t(rootsX) * rootsY * leaves * leaves;
+    }
+    const float* getMorphStarts() const { return morphStarts; }
+    const float* getMorphEnds() const { return ranges; }
+};
+
+#endif // CDLOD_TREE_HPP
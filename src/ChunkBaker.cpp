@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <type_traits>
+
+#include "ChunkBaker.hpp"
+#include "Parallel.hpp"
+#include "Defines.hpp"
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{ return (value + alignment - 1u) / alignment * alignment; }
+
+static void writeAt(FILE* file, uint64_t offset, const void* data, size_t size, const std::string& path)
+{
+    if (fseeko(file, static_cast<off_t>(offset), SEEK_SET) != 0 || fwrite(data, 1, size, file) != size)
+        EXIT("Failed to write " + path);
+}
+
+// One chunk's meshes, vertex and index ranges relative to the chunk
+struct ChunkBuild {
+    ChunkEntry entry;
+    ChunkMesh meshes[CHUNKS_MAX_LODS];
+    std::vector<ChunkVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief Hypotenuse corners (ax, ay, bx, by) of every triangle of the right
+ * triangle hierarchy over a size x size quad grid, in Martini's order: the two
+ * roots first, every triangle's children after it.
+ */
+static std::vector<uint16_t> buildRtinCoords(uint32_t size)
+{
+    const size_t triangleCount = 2u * size_t(size) * size - 2u;
+    std::vector<uint16_t> coords(4u * triangleCount);
+
+    for (size_t i = 0u; i < triangleCount; ++i)
+    {
+        size_t id = i + 2u;
+        uint32_t ax = 0u, ay = 0u, bx = 0u, by = 0u, cx = 0u, cy = 0u;
+        if (id & 1u)
+            bx = by = cx = size;
+        else
+            ax = ay = cy = size;
+
+        while ((id >>= 1u) > 1u)
+        {
+            const uint32_t mx = (ax + bx) >> 1u;
+            const uint32_t my = (ay + by) >> 1u;
+            if (id & 1u) { bx = ax; by = ay; ax = cx; ay = cy; }
+            else         { ax = bx; ay = by; bx = cx; by = cy; }
+            cx = mx;
+            cy = my;
+        }
+
+        coords[4u * i + 0u] = static_cast<uint16_t>(ax);
+        coords[4u * i + 1u] = static_cast<uint16_t>(ay);
+        coords[4u * i + 2u] = static_cast<uint16_t>(bx);
+        coords[4u * i + 3u] = static_cast<uint16_t>(by);
+    }
+
+    return coords;
+}
+
+/**
+ * @brief Error of every vertex as the hypotenuse midpoint of the hierarchy:
+ * its own interpolation error, raised to those of its descendants so that a
+ * triangle left unsplit bounds the error of everything inside it.
+ */
+static void computeRtinErrors(const float* heights, uint32_t size, const std::vector<uint16_t>& coords,
+                              std::vector<float>& errors)
+{
+    const uint32_t stride = size + 1u;
+    const size_t triangleCount = coords.size() / 4u;
+    const size_t parentCount = triangleCount - size_t(size) * size;
+    errors.assign(size_t(stride) * stride, 0.0f);
+
+    for (size_t i = triangleCount; i-- > 0u; )
+    {
+        const int32_t ax = coords[4u * i + 0u], ay = coords[4u * i + 1u];
+        const int32_t bx = coords[4u * i + 2u], by = coords[4u * i + 3u];
+        const int32_t mx = (ax + bx) >> 1;
+        const int32_t my = (ay + by) >> 1;
+        const int32_t cx = mx + my - ay;
+        const int32_t cy = my + ax - mx;
+
+        const size_t middle = size_t(my) * stride + mx;
+        const float interpolated = 0.5f * (heights[size_t(ay) * stride + ax] + heights[size_t(by) * stride + bx]);
+        float error = std::max(errors[middle], fabsf(interpolated - heights[middle]));
+
+        if (i < parentCount)
+        {
+            const size_t left = size_t((ay + cy) >> 1) * stride + ((ax + cx) >> 1);
+            const size_t right = size_t((by + cy) >> 1) * stride + ((bx + cx) >> 1);
+            error = std::max({ error, errors[left], errors[right] });
+        }
+        errors[middle] = error;
+    }
+}
+
+// Largest vertical distance of the samples under a triangle to its plane
+static float triangleError(const float* heights, uint32_t stride, int32_t ax, int32_t ay, int32_t bx, int32_t by,
+                           int32_t cx, int32_t cy)
+{
+    const int32_t area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    const float ha = heights[size_t(ay) * stride + ax];
+    const float hb = heights[size_t(by) * stride + bx];
+    const float hc = heights[size_t(cy) * stride + cx];
+
+    float error = 0.0f;
+    for (int32_t y = std::min({ ay, by, cy }); y <= std::max({ ay, by, cy }); ++y)
+    {
+        for (int32_t x = std::min({ ax, bx, cx }); x <= std::max({ ax, bx, cx }); ++x)
+        {
+            // Edge functions share the sign of the area inside the triangle
+            const int32_t wa = (bx - x) * (cy - y) - (by - y) * (cx - x);
+            const int32_t wb = (cx - x) * (ay - y) - (cy - y) * (ax - x);
+            const int32_t wc = area - wa - wb;
+            if ((area < 0) ? (wa > 0 || wb > 0 || wc > 0) : (wa < 0 || wb < 0 || wc < 0))
+                continue;
+
+            const float interpolated = (wa * ha + wb * hb + wc * hc) / static_cast<float>(area);
+            error = std::max(error, fabsf(interpolated - heights[size_t(y) * stride + x]));
+        }
+    }
+    return error;
+}
+
+/**
+ * @brief Cuts the hierarchy at maxError into triangles wound like the tile
+ * grids, hangs a skirt from every border edge and appends the mesh to build.
+ */
+static ChunkMesh extractRtinMesh(const float* heights, const float* gradients, const std::vector<float>& errors,
+                                 uint32_t size, float maxError, float skirtHeight, std::vector<int32_t>& remap,
+                                 ChunkBuild& build)
+{
+    const uint32_t stride = size + 1u;
+    ChunkMesh mesh { static_cast<uint32_t>(build.vertices.size()), 0u, static_cast<uint32_t>(build.indices.size()), 0u,
+                     0.0f, 0u };
+
+    remap.assign(size_t(stride) * stride, -1);
+    std::vector<int32_t> skirtRemap(remap.size(), -1);
+
+    auto vertex = [&](std::vector<int32_t>& table, int32_t x, int32_t y, bool skirt) {
+        const size_t sample = size_t(y) * stride + x;
+        if (table[sample] < 0)
+        {
+            table[sample] = static_cast<int32_t>(build.vertices.size() - mesh.firstVertex);
+            build.vertices.push_back({ { static_cast<uint16_t>(x), static_cast<uint16_t>(y) },
+                                       skirt ? skirtHeight : heights[sample],
+                                       { gradients[2u * sample], gradients[2u * sample + 1u] } });
+        }
+        return static_cast<uint32_t>(table[sample]);
+    };
+
+    const int32_t last = static_cast<int32_t>(size);
+    auto onBorder = [last](int32_t ax, int32_t ay, int32_t bx, int32_t by) {
+        return (ax == bx && (ax == 0 || ax == last)) || (ay == by && (ay == 0 || ay == last));
+    };
+
+    auto emit = [&](auto& self, int32_t ax, int32_t ay, int32_t bx, int32_t by, int32_t cx, int32_t cy) -> void {
+        const int32_t mx = (ax + bx) >> 1;
+        const int32_t my = (ay + by) >> 1;
+        const bool splittable = abs(ax - cx) + abs(ay - cy) > 1;
+
+        if (splittable && errors[size_t(my) * stride + mx] > maxError)
+        {
+            self(self, cx, cy, ax, ay, mx, my);
+            self(self, bx, by, cx, cy, mx, my);
+            return;
+        }
+
+        // The hierarchy's errors only see midpoints, record the exact one
+        if (splittable)
+            mesh.error = std::max(mesh.error, triangleError(heights, stride, ax, ay, bx, by, cx, cy));
+
+        // Clockwise in (x, y) sample space, like buildGridTriangles
+        if ((bx - ax) * (cy - ay) - (by - ay) * (cx - ax) > 0)
+        {
+            std::swap(bx, cx);
+            std::swap(by, cy);
+        }
+        build.indices.insert(build.indices.end(), { vertex(remap, ax, ay, false), vertex(remap, bx, by, false),
+                                                    vertex(remap, cx, cy, false) });
+
+        const int32_t corners[3][2] = { { ax, ay }, { bx, by }, { cx, cy } };
+        for (uint32_t e = 0u; e < 3u; ++e)
+        {
+            const int32_t* p = corners[e];
+            const int32_t* q = corners[(e + 1u) % 3u];
+            if (!onBorder(p[0], p[1], q[0], q[1]))
+                continue;
+
+            const uint32_t top0 = vertex(remap, p[0], p[1], false);
+            const uint32_t top1 = vertex(remap, q[0], q[1], false);
+            const uint32_t bottom0 = vertex(skirtRemap, p[0], p[1], true);
+            const uint32_t bottom1 = vertex(skirtRemap, q[0], q[1], true);
+            build.indices.insert(build.indices.end(), { top0, bottom0, top1, top1, bottom0, bottom1 });
+        }
+    };
+
+    emit(emit, 0, 0, last, last, last, 0);
+    emit(emit, last, last, 0, 0, 0, last);
+
+    mesh.vertexCount = static_cast<uint32_t>(build.vertices.size()) - mesh.firstVertex;
+    mesh.indexCount = static_cast<uint32_t>(build.indices.size()) - mesh.firstIndex;
+    return mesh;
+}
+
+template<typename T>
+static float normalizedHeight(T value)
+{
+    if constexpr (std::is_same_v<T, uint16_t>)
+        return value / 65535.0f;
+    else
+        return value;
+}
+
+/**
+ * @brief Meshes chunk (cx, cy) at every lod. Samples past the map clamp to its
+ * last row/column, like the padding of pyramid edge tiles.
+ */
+template<typename T>
+static void buildChunk(const HeightImage& src, const ChunkBakeSettings& settings, const std::vector<uint16_t>& coords,
+                       uint32_t cx, uint32_t cy, ChunkBuild& build)
+{
+    const uint32_t size = settings.chunkSize;
+    const uint32_t stride = size + 1u;
+    const T* samples = static_cast<const T*>(src.data);
+
+    auto sample = [&](int64_t x, int64_t y) {
+        x = std::clamp<int64_t>(x, 0, src.width - 1u);
+        y = std::clamp<int64_t>(y, 0, src.height - 1u);
+        return normalizedHeight(samples[size_t(y) * src.width + size_t(x)]);
+    };
+
+    const int64_t x0 = int64_t(cx) * size;
+    const int64_t y0 = int64_t(cy) * size;
+
+    std::vector<float> heights(size_t(stride) * stride);
+    std::vector<float> gradients(2u * heights.size());
+    for (uint32_t y = 0u; y < stride; ++y)
+    {
+        for (uint32_t x = 0u; x < stride; ++x)
+        {
+            const int64_t sx = x0 + x, sy = y0 + y;
+            const size_t i = size_t(y) * stride + x;
+            heights[i] = sample(sx, sy);
+
+            // Sobel, scaled to rise per sample like the clipmap's normals
+            gradients[2u * i] = ((sample(sx + 1, sy - 1) + 2.0f * sample(sx + 1, sy) + sample(sx + 1, sy + 1)) -
+                                 (sample(sx - 1, sy - 1) + 2.0f * sample(sx - 1, sy) + sample(sx - 1, sy + 1))) / 8.0f;
+            gradients[2u * i + 1u] = ((sample(sx - 1, sy + 1) + 2.0f * sample(sx, sy + 1) + sample(sx + 1, sy + 1)) -
+                                      (sample(sx - 1, sy - 1) + 2.0f * sample(sx, sy - 1) + sample(sx + 1, sy - 1))) / 8.0f;
+        }
+    }
+
+    const auto [lo, hi] = std::minmax_element(heights.begin(), heights.end());
+    build.entry = {};
+    build.entry.minHeight = *lo;
+    build.entry.maxHeight = *hi;
+
+    std::vector<float> errors;
+    computeRtinErrors(heights.data(), size, coords, errors);
+
+    // A grid with a spacing of 2^level leaves every vertex off its lattice unsplit
+    for (uint32_t level = 0u; (size >> level) > 0u && level < CHUNKS_MAX_GRID_LEVELS; ++level)
+    {
+        const uint32_t mask = (1u << level) - 1u;
+        float error = 0.0f;
+        for (uint32_t y = 0u; y < stride; ++y)
+            for (uint32_t x = 0u; x < stride; ++x)
+                if ((x & mask) || (y & mask))
+                    error = std::max(error, errors[size_t(y) * stride + x]);
+        build.entry.gridErrors[level] = error;
+    }
+
+    build.vertices.clear();
+    build.indices.clear();
+    std::vector<int32_t> remap;
+    for (uint32_t lod = 0u; lod < settings.lodErrors.size(); ++lod)
+        build.meshes[lod] = extractRtinMesh(heights.data(), gradients.data(), errors, size, settings.lodErrors[lod],
+                                            build.entry.minHeight, remap, build);
+}
+
+template<typename T>
+static void bake(const HeightImage& src, const std::string& outPath, const ChunkBakeSettings& settings)
+{
+    const uint32_t size = settings.chunkSize;
+    const uint32_t lodCount = static_cast<uint32_t>(settings.lodErrors.size());
+    const uint32_t chunksX = (src.width + size - 1u) / size;
+    const uint32_t chunksY = (src.height + size - 1u) / size;
+    const size_t chunkCount = size_t(chunksX) * chunksY;
+
+    uint32_t gridLevels = 0u;
+    while ((size >> gridLevels) > 0u && gridLevels < CHUNKS_MAX_GRID_LEVELS)
+        ++gridLevels;
+
+    const std::vector<uint16_t> coords = buildRtinCoords(size);
+
+    // Tables are written last; vertices stream to their block, indices to a
+    // temporary file appended once the vertex count is known
+    std::vector<ChunkEntry> entries(chunkCount);
+    std::vector<ChunkMesh> meshes(chunkCount * lodCount);
+    const uint64_t tablesEnd = sizeof(ChunkHeader) + sizeof(ChunkEntry) * entries.size() + sizeof(ChunkMesh) * meshes.size();
+    const uint64_t vertexOffset = alignUp(tablesEnd, CHUNKS_DATA_ALIGNMENT);
+
+    FILE* file = fopen(outPath.c_str(), "wb");
+    FILE* indexFile = tmpfile();
+    if (!file || !indexFile)
+        EXIT("Failed to create " + outPath);
+
+    std::vector<ChunkBuild> row(chunksX);
+    uint64_t vertexCount = 0u;
+    uint64_t indexCount = 0u;
+
+    for (uint32_t cy = 0u; cy < chunksY; ++cy)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        parallelFor(chunksX, [&](size_t begin, size_t end) {
+            for (uint32_t cx = begin; cx < end; ++cx)
+                buildChunk<T>(src, settings, coords, cx, cy, row[cx]);
+        });
+
+        uint64_t rowTriangles = 0u;
+        for (uint32_t cx = 0u; cx < chunksX; ++cx)
+        {
+            const size_t chunk = size_t(cy) * chunksX + cx;
+            const ChunkBuild& build = row[cx];
+            entries[chunk] = build.entry;
+
+            for (uint32_t lod = 0u; lod < lodCount; ++lod)
+            {
+                ChunkMesh mesh = build.meshes[lod];
+                mesh.firstVertex += static_cast<uint32_t>(vertexCount);
+                mesh.firstIndex += static_cast<uint32_t>(indexCount);
+                meshes[chunk * lodCount + lod] = mesh;
+            }
+            rowTriangles += build.indices.size() / 3u;
+
+            writeAt(file, vertexOffset + sizeof(ChunkVertex) * vertexCount, build.vertices.data(),
+                    sizeof(ChunkVertex) * build.vertices.size(), outPath);
+            if (fwrite(build.indices.data(), sizeof(uint32_t), build.indices.size(), indexFile) != build.indices.size())
+                EXIT("Failed to write indices of " + outPath);
+
+            vertexCount += build.vertices.size();
+            indexCount += build.indices.size();
+            if (vertexCount > UINT32_MAX || indexCount > UINT32_MAX)
+                EXIT("Chunk meshes of " + outPath + " exceed 32-bit counts, raise the lod errors");
+        }
+
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        LOG("  row %u: %u chunks, %llu triangles over %u lods, %.1f ms\n", cy, chunksX,
+            static_cast<unsigned long long>(rowTriangles), lodCount, elapsed.count());
+    }
+
+    // Appends the indices after the vertices
+    const uint64_t indexOffset = alignUp(vertexOffset + sizeof(ChunkVertex) * vertexCount, CHUNKS_DATA_ALIGNMENT);
+    {
+        std::vector<uint8_t> block(1u << 20u);
+        rewind(indexFile);
+        uint64_t offset = indexOffset;
+        size_t read;
+        while ((read = fread(block.data(), 1, block.size(), indexFile)) > 0u)
+        {
+            writeAt(file, offset, block.data(), read, outPath);
+            offset += read;
+        }
+        fclose(indexFile);
+    }
+
+    const ChunkHeader header {
+        CHUNKS_MAGIC, CHUNKS_VERSION, src.format, src.width, src.height, size, chunksX, chunksY, lodCount, gridLevels,
+        static_cast<uint32_t>(vertexCount), static_cast<uint32_t>(indexCount), vertexOffset, indexOffset
+    };
+    writeAt(file, 0u, &header, sizeof(header), outPath);
+    writeAt(file, sizeof(header), entries.data(), sizeof(ChunkEntry) * entries.size(), outPath);
+    writeAt(file, sizeof(header) + sizeof(ChunkEntry) * entries.size(), meshes.data(),
+            sizeof(ChunkMesh) * meshes.size(), outPath);
+
+    if (fclose(file) != 0)
+        EXIT("Failed to finalize " + outPath);
+}
+
+void bakeChunks(const HeightImage& src, const std::string& outPath, const ChunkBakeSettings& settings)
+{
+    if (!src.data || src.width == 0u || src.height == 0u)
+        EXIT("Empty source heightmap");
+    if (settings.chunkSize < 2u || settings.chunkSize > 4096u || (settings.chunkSize & (settings.chunkSize - 1u)) != 0u)
+        EXIT("Chunk size must be a power of two from 2 to 4096");
+    if (settings.lodErrors.empty() || settings.lodErrors.size() > CHUNKS_MAX_LODS)
+        EXIT("Chunks need 1 to " + std::to_string(CHUNKS_MAX_LODS) + " lod errors");
+
+    if (src.format == PYRAMID_FORMAT_F32)
+        bake<float>(src, outPath, settings);
+    else
+        bake<uint16_t>(src, outPath, settings);
+}
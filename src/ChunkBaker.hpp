@@ -0,0 +1,24 @@
+#ifndef CHUNK_BAKER_HPP
+#define CHUNK_BAKER_HPP
+
+#include <string>
+#include <vector>
+
+#include "HeightmapLoader.hpp"
+#include "TerrainChunks.hpp"
+
+struct ChunkBakeSettings {
+    uint32_t chunkSize = 256u;
+    // Maximum normalized vertical error of every lod, finest first
+    std::vector<float> lodErrors { 1.0f / 128.0f, 1.0f / 64.0f, 1.0f / 32.0f, 1.0f / 16.0f, 1.0f / 8.0f };
+};
+
+/**
+ * @brief Writes src as a .tchk file. Every chunk's error hierarchy is built
+ * once (Martini's RTIN) and cut at each lod's threshold; rows of chunks are
+ * meshed in parallel across all hardware threads and streamed out, so only one
+ * row of meshes is held in memory at a time.
+ */
+void bakeChunks(const HeightImage& src, const std::string& outPath, const ChunkBakeSettings& settings);
+
+#endif // CHUNK_BAKER_HPP
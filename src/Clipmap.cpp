@@ -0,0 +1,424 @@
+#include <string.h>
+#include <algorithm>
+
+#include "Clipmap.hpp"
+#include "Defines.hpp"
+#include "Helpers.hpp"
+#include "HeightKernels.hpp"
+#include "Parallel.hpp"
+
+void Clipmap::create(GLuint textureHandle, GLuint normalHandle, GLuint uploadBuffer, const TerrainPyramid& source,
+                     TileCache& tileCache, uint32_t levelCount, uint32_t textureDim, size_t budget, float scale,
+                     bool halfFloat)
+{
+    if (textureDim < PIECE_DIM || (textureDim & (textureDim - 1u)) != 0u)
+        EXIT("Clipmap dimension must be a power of two of at least " + std::to_string(PIECE_DIM));
+    if (levelCount > source.levelCount())
+        EXIT("Pyramid has " + std::to_string(source.levelCount()) + " levels, clipmap needs " +
+             std::to_string(levelCount) + " (re-bake with --levels)");
+
+    texture = textureHandle;
+    normalTexture = normalHandle;
+    heightScale = scale;
+    pyramid = &source;
+    cache = &tileCache;
+    dim = textureDim;
+    uploadBudget = budget;
+    levels.assign(levelCount, LevelState {});
+    for (LevelState& state : levels)
+        state.pendingPieces.assign((dim / PIECE_DIM) * (dim / PIECE_DIM), 0u);
+
+    // Heights only ever need one channel; float sources may trade precision for half the memory
+    const bool isFloat = source.format() == PYRAMID_FORMAT_F32;
+    const GLenum internalFormat = isFloat ? (halfFloat ? GL_R16F : GL_R32F) : GL_R16;
+    uploadType = isFloat ? GL_FLOAT : GL_UNSIGNED_SHORT;
+
+    gpuBytes = allocateTextureStorage(texture, GL_TEXTURE_2D_ARRAY, internalFormat, dim, dim, levelCount, 1, "clipmap");
+    gpuBytes += allocateTextureStorage(normalTexture, GL_TEXTURE_2D_ARRAY, GL_RG8_SNORM, dim, dim, levelCount, 1,
+                                       "clipmap normals");
+
+    for (GLuint handle : { texture, normalTexture })
+    {
+        glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    // A slot holds a piece's heights followed by its normals. Enough slots to
+    // keep a couple of frames worth of budget in flight
+    normalOffset = source.sampleSize() * PIECE_DIM * PIECE_DIM;
+    const size_t slotSize = normalOffset + 2u * PIECE_DIM * PIECE_DIM;
+    const uint32_t slotCount = std::max<uint32_t>(64u, 3u * uploadBudget / slotSize);
+    ring.create(uploadBuffer, slotSize, slotCount);
+    slotPieces.resize(slotCount);
+
+    // Leave one core to the render thread
+    pool.start(hardwareThreadCount() - 1u, [this](uint32_t slot) { decodePiece(slotPieces[slot], ring.data(slot)); });
+}
+
+void Clipmap::destroy()
+{
+    pool.stop();
+
+    for (uint32_t level = 0u; level < levels.size(); ++level)
+    {
+        levels[level].valid = false;
+        pinWindow(level, levels[level]);
+    }
+
+    waiting.clear();
+    ready.clear();
+    slotPieces.clear();
+    ring.destroy();
+    levels.clear();
+    pyramid = nullptr;
+    cache = nullptr;
+}
+
+/**
+ * @brief Gathers a level-space rectangle from cached pyramid tiles into a
+ * tightly packed buffer. Coordinates outside the level clamp to its edge.
+ */
+void Clipmap::readRegion(uint32_t level, int32_t x0, int32_t y0, uint32_t w, uint32_t h, uint8_t* dst) const
+{
+    const PyramidLevel& lvl = pyramid->level(level);
+    const int32_t tileSize = static_cast<int32_t>(pyramid->tileSize());
+    const size_t sampleSize = pyramid->sampleSize();
+    const int32_t maxX = static_cast<int32_t>(lvl.width) - 1;
+    const int32_t maxY = static_cast<int32_t>(lvl.height) - 1;
+
+    // A region touches a handful of tiles, acquire each once for the whole gather
+    struct Acquired { int32_t tx, ty; const uint8_t* data; };
+    std::vector<Acquired> acquired;
+    auto tileData = [&](int32_t tx, int32_t ty) {
+        for (const Acquired& a : acquired)
+        {
+            if (a.tx == tx && a.ty == ty)
+                return a.data;
+        }
+        acquired.push_back({ tx, ty, cache->acquire(level, tx, ty) });
+        return acquired.back().data;
+    };
+
+    for (uint32_t row = 0u; row < h; ++row)
+    {
+        const int32_t sy = std::clamp(y0 + static_cast<int32_t>(row), 0, maxY);
+        const int32_t ty = sy / tileSize;
+        const int32_t iy = sy % tileSize;
+        uint8_t* out = dst + sampleSize * w * row;
+
+        for (int32_t x = x0, end = x0 + static_cast<int32_t>(w); x < end; )
+        {
+            const int32_t sx = std::clamp(x, 0, maxX);
+            const int32_t tx = sx / tileSize;
+            const int32_t ix = sx % tileSize;
+
+            // Outside the level a single edge sample is replicated, inside we copy
+            // up to the end of the current tile
+            const int32_t run = (x < 0 || x > maxX) ? 1 : std::min({ end - x, tileSize - ix, maxX + 1 - x });
+
+            memcpy(out, tileData(tx, ty) + sampleSize * (size_t(iy) * tileSize + ix), sampleSize * run);
+
+            out += sampleSize * run;
+            x += run;
+        }
+    }
+
+    for (const Acquired& a : acquired)
+        cache->release(level, a.tx, a.ty);
+}
+
+/**
+ * @brief Fills a slot with a piece's heights and the normals baked from them.
+ * Heights are gathered with a one-texel border for the Sobel filter, so normals
+ * are seamless across pieces.
+ */
+void Clipmap::decodePiece(const Piece& piece, uint8_t* dst) const
+{
+    const size_t sampleSize = pyramid->sampleSize();
+    const uint32_t w = piece.size.x;
+    const uint32_t h = piece.size.y;
+    const uint32_t stride = w + 2u;
+
+    thread_local std::vector<uint8_t> bordered;
+    bordered.resize(sampleSize * stride * (h + 2u));
+    readRegion(piece.level, piece.origin.x - 1, piece.origin.y - 1, stride, h + 2u, bordered.data());
+
+    for (uint32_t row = 0u; row < h; ++row)
+        memcpy(dst + sampleSize * w * row, bordered.data() + sampleSize * (size_t(row + 1u) * stride + 1u), sampleSize * w);
+
+    // One level texel spans 2^level world units
+    const float spacing = static_cast<float>(1u << piece.level);
+    int8_t* normals = reinterpret_cast<int8_t*>(dst + normalOffset);
+
+    if (pyramid->format() == PYRAMID_FORMAT_F32)
+    {
+        const float* src = reinterpret_cast<const float*>(bordered.data()) + stride + 1u;
+        sobelNormals(src, stride, w, h, heightScale / (8.0f * spacing), normals, w);
+    }
+    else
+    {
+        const uint16_t* src = reinterpret_cast<const uint16_t*>(bordered.data()) + stride + 1u;
+        sobelNormals(src, stride, w, h, heightScale / (65535.0f * 8.0f * spacing), normals, w);
+    }
+}
+
+/**
+ * @brief Pins the cache tiles under a level's window and unpins the ones it left.
+ * An invalid state unpins everything.
+ */
+void Clipmap::pinWindow(uint32_t level, LevelState& state)
+{
+    glm::ivec4 range { 0, 0, -1, -1 };
+    if (state.valid)
+    {
+        const PyramidLevel& lvl = pyramid->level(level);
+        const int32_t tileSize = static_cast<int32_t>(pyramid->tileSize());
+        const glm::ivec2 maxTile { static_cast<int32_t>(lvl.tilesX) - 1, static_cast<int32_t>(lvl.tilesY) - 1 };
+        const glm::ivec2 lo = glm::clamp(state.origin, glm::ivec2(0), glm::ivec2(lvl.width - 1u, lvl.height - 1u));
+        const glm::ivec2 hi = glm::clamp(state.origin + glm::ivec2(dim - 1u), glm::ivec2(0), glm::ivec2(lvl.width - 1u, lvl.height - 1u));
+        range = glm::ivec4(glm::min(lo / tileSize, maxTile), glm::min(hi / tileSize, maxTile));
+    }
+
+    if (range == state.pinned)
+        return;
+
+    auto contains = [](const glm::ivec4& r, int32_t tx, int32_t ty) {
+        return tx >= r.x && tx <= r.z && ty >= r.y && ty <= r.w;
+    };
+
+    for (int32_t ty = range.y; ty <= range.w; ++ty)
+        for (int32_t tx = range.x; tx <= range.z; ++tx)
+            if (!contains(state.pinned, tx, ty))
+                cache->pin(level, tx, ty);
+
+    for (int32_t ty = state.pinned.y; ty <= state.pinned.w; ++ty)
+        for (int32_t tx = state.pinned.x; tx <= state.pinned.z; ++tx)
+            if (!contains(range, tx, ty))
+                cache->unpin(level, tx, ty);
+
+    state.pinned = range;
+}
+
+/**
+ * @brief Cuts a level-space rectangle into pieces along the PIECE_DIM grid.
+ * As dim is a multiple of PIECE_DIM, no piece straddles the toroidal wrap.
+ */
+void Clipmap::requestRegion(uint32_t level, int32_t x0, int32_t y0, uint32_t w, uint32_t h)
+{
+    const int32_t pieceDim = static_cast<int32_t>(PIECE_DIM);
+    const int32_t x1 = x0 + static_cast<int32_t>(w);
+    const int32_t y1 = y0 + static_cast<int32_t>(h);
+
+    for (int32_t y = y0; y < y1; )
+    {
+        const int32_t yEnd = std::min(y1, (y & ~(pieceDim - 1)) + pieceDim);
+        for (int32_t x = x0; x < x1; )
+        {
+            const int32_t xEnd = std::min(x1, (x & ~(pieceDim - 1)) + pieceDim);
+            waiting.push_back({ level, { x, y }, { xEnd - x, yEnd - y } });
+            ++pendingPieces(waiting.back());
+            x = xEnd;
+        }
+        y = yEnd;
+    }
+}
+
+bool Clipmap::overlapsWindow(const Piece& piece) const
+{
+    const glm::ivec2 lo = glm::max(piece.origin, levels[piece.level].origin);
+    const glm::ivec2 hi = glm::min(piece.origin + piece.size, levels[piece.level].origin + glm::ivec2(dim));
+    return lo.x < hi.x && lo.y < hi.y;
+}
+
+// A piece never straddles a cell, see requestRegion()
+uint32_t& Clipmap::pendingPieces(const Piece& piece)
+{
+    const int32_t mask = static_cast<int32_t>(dim) - 1;
+    const uint32_t cellsPerSide = dim / PIECE_DIM;
+    const uint32_t cellX = static_cast<uint32_t>(piece.origin.x & mask) / PIECE_DIM;
+    const uint32_t cellY = static_cast<uint32_t>(piece.origin.y & mask) / PIECE_DIM;
+    return levels[piece.level].pendingPieces[cellY * cellsPerSide + cellX];
+}
+
+/**
+ * @brief Texels of a cell without pending pieces are resident: each of them
+ * was requested when it entered the window, and its piece was uploaded rather
+ * than cancelled, as only pieces outside the window are. Pieces still pending
+ * for texels that left the window keep the cell out conservatively.
+ */
+bool Clipmap::isResident(uint32_t level, const glm::ivec2& lo, const glm::ivec2& hi) const
+{
+    const LevelState& state = levels[level];
+    const glm::ivec2 end = state.origin + glm::ivec2(dim);
+    if (!state.valid || lo.x < state.origin.x || lo.y < state.origin.y || hi.x >= end.x || hi.y >= end.y)
+        return false;
+
+    const int32_t mask = static_cast<int32_t>(dim) - 1;
+    const int32_t pieceDim = static_cast<int32_t>(PIECE_DIM);
+    const uint32_t cellsPerSide = dim / PIECE_DIM;
+    for (int32_t y = lo.y & ~(pieceDim - 1); y <= hi.y; y += pieceDim)
+    {
+        for (int32_t x = lo.x & ~(pieceDim - 1); x <= hi.x; x += pieceDim)
+        {
+            const uint32_t cell = static_cast<uint32_t>(y & mask) / PIECE_DIM * cellsPerSide +
+                                  static_cast<uint32_t>(x & mask) / PIECE_DIM;
+            if (state.pendingPieces[cell] != 0u)
+                return false;
+        }
+    }
+    return true;
+}
+
+uint32_t Clipmap::finestResidentLevel(uint32_t footprint) const
+{
+    // Windows are centered on the snapped camera, so is the footprint
+    const glm::ivec2 offset { static_cast<int32_t>(dim - std::min(footprint, dim)) / 2 };
+    const glm::ivec2 extent { static_cast<int32_t>(std::min(footprint, dim)) - 1 };
+
+    uint32_t finest = static_cast<uint32_t>(levels.size()) - 1u;
+    while (finest > 0u)
+    {
+        const glm::ivec2 lo = levels[finest - 1u].origin + offset;
+        if (!isResident(finest - 1u, lo, lo + extent))
+            break;
+        --finest;
+    }
+    return finest;
+}
+
+void Clipmap::update(const glm::vec3& cameraPos)
+{
+    frameUploadBytes = 0u;
+
+    const int32_t size = static_cast<int32_t>(dim);
+
+    // Coarsest level first, so its pieces are first in line for ring slots too
+    for (uint32_t level = static_cast<uint32_t>(levels.size()); level-- > 0u; )
+    {
+        // Same snapping as the ring placement in render(): one level texel is 2^level world units
+        const float texelSize = static_cast<float>(1u << level);
+        const glm::ivec2 snapped { glm::floor(glm::vec2(cameraPos.x, cameraPos.z) / texelSize) };
+        const glm::ivec2 origin = snapped - glm::ivec2(size / 2);
+
+        LevelState& state = levels[level];
+        const glm::ivec2 delta = origin - state.origin;
+
+        if (!state.valid || std::abs(delta.x) >= size || std::abs(delta.y) >= size)
+        {
+            requestRegion(level, origin.x, origin.y, dim, dim);
+        }
+        else if (delta != glm::ivec2(0))
+        {
+            // Columns that entered the window, over its full new height
+            const int32_t colX = delta.x > 0 ? state.origin.x + size : origin.x;
+            requestRegion(level, colX, origin.y, std::abs(delta.x), dim);
+
+            // Rows that entered the window, minus the columns requested above
+            const int32_t rowY = delta.y > 0 ? state.origin.y + size : origin.y;
+            const int32_t rowX = std::max(origin.x, state.origin.x);
+            requestRegion(level, rowX, rowY, size - std::abs(delta.x), std::abs(delta.y));
+        }
+
+        state.valid = true;
+        state.origin = origin;
+        pinWindow(level, state);
+    }
+
+    // Drop queued pieces that already scrolled out of their window
+    pool.setFocus({ cameraPos.x, cameraPos.z });
+
+    scratchSlots.clear();
+    pool.retainIf([this](const TileDecodePool::Request& request) { return overlapsWindow(slotPieces[request.id]); },
+                  scratchSlots);
+    for (uint32_t slot : scratchSlots)
+    {
+        --pendingPieces(slotPieces[slot]);
+        ring.recycle(slot);
+    }
+
+    // Hand as many waiting pieces to the pool as there are free slots
+    uint64_t cancelled = 0u;
+    while (!waiting.empty())
+    {
+        const Piece& piece = waiting.front();
+        if (!overlapsWindow(piece))
+        {
+            ++cancelled;
+            --pendingPieces(piece);
+            waiting.pop_front();
+            continue;
+        }
+
+        const int32_t slot = ring.acquire();
+        if (slot < 0)
+            break;
+
+        const float texelSize = static_cast<float>(1u << piece.level);
+        const glm::vec2 center = (glm::vec2(piece.origin) + glm::vec2(piece.size) * 0.5f) * texelSize;
+
+        slotPieces[slot] = piece;
+        pool.submit({ piece.level, center, static_cast<uint32_t>(slot) });
+        waiting.pop_front();
+    }
+
+    scratchSlots.clear();
+    pool.collect(scratchSlots);
+    ready.insert(ready.end(), scratchSlots.begin(), scratchSlots.end());
+
+    // Upload finished pieces until the frame's budget is spent, coarsest level
+    // first like requests and decoding; workers finish out of order, so sort the
+    // backlog again. A deferred piece stays pending and keeps its cell out of
+    // residency until a later frame uploads it. Piece rows are tightly packed
+    // and may be any width
+    std::stable_sort(ready.begin(), ready.end(),
+                     [this](uint32_t a, uint32_t b) { return slotPieces[a].level > slotPieces[b].level; });
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.getBuffer());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    const int32_t mask = size - 1;
+    while (!ready.empty() && frameUploadBytes < uploadBudget)
+    {
+        const uint32_t slot = ready.front();
+        const Piece& piece = slotPieces[slot];
+        ready.pop_front();
+
+        const LevelState& state = levels[piece.level];
+        const glm::ivec2 lo = glm::max(piece.origin, state.origin);
+        const glm::ivec2 hi = glm::min(piece.origin + piece.size, state.origin + glm::ivec2(size));
+
+        if (lo.x >= hi.x || lo.y >= hi.y)
+        {
+            ++cancelled;
+            --pendingPieces(piece);
+            ring.recycle(slot);
+            continue;
+        }
+
+        const glm::ivec2 skip = lo - piece.origin;
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, piece.size.x);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, skip.x);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, skip.y);
+        glTextureSubImage3D(texture, 0, lo.x & mask, lo.y & mask, piece.level,
+                            hi.x - lo.x, hi.y - lo.y, 1, GL_RED, uploadType,
+                            reinterpret_cast<const void*>(ring.offset(slot)));
+        glTextureSubImage3D(normalTexture, 0, lo.x & mask, lo.y & mask, piece.level,
+                            hi.x - lo.x, hi.y - lo.y, 1, GL_RG, GL_BYTE,
+                            reinterpret_cast<const void*>(ring.offset(slot) + normalOffset));
+        ring.release(slot);
+        --pendingPieces(piece);
+
+        frameUploadBytes += (pyramid->sampleSize() + 2u) * (hi.x - lo.x) * (hi.y - lo.y);
+    }
+
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+
+    if (cancelled)
+        pool.addCancelled(cancelled);
+}
@@ -0,0 +1,119 @@
+#ifndef CLIPMAP_HPP
+#define CLIPMAP_HPP
+
+#include <deque>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "TerrainPyramid.hpp"
+#include "UploadRing.hpp"
+#include "TileDecodePool.hpp"
+#include "TileCache.hpp"
+
+/**
+ * @brief One dim x dim layer per clipmap level in a GL_TEXTURE_2D_ARRAY,
+ * addressed toroidally: level texel (x, y) lives at (x mod dim, y mod dim).
+ * Each layer holds a window of its pyramid level centered on the snapped
+ * camera, and moving the camera only requests the newly exposed L-shaped strip.
+ *
+ * Strips are cut into PIECE_DIM aligned pieces. Decode workers gather each
+ * piece from the tile cache straight into an UploadRing slot, coarsest level
+ * and then nearest first, and pieces that leave their window before a worker
+ * gets to them are cancelled. The render thread turns finished pieces into texture uploads
+ * within a per-frame byte budget, coarsest level first, clipped to the level's
+ * current window so late pieces never overwrite newer data.
+ *
+ * A window moves before its new texels arrive, so every level counts the
+ * pieces in flight per PIECE_DIM cell of its layer, including those the budget
+ * deferred. Texels are resident once their cell has none left, and renderers
+ * only sample a level where they are.
+ *
+ * Alongside the heights, workers bake each piece's Sobel normals into a second
+ * RG8_SNORM array with the same layout, so shading needs a single fetch.
+ */
+class Clipmap
+{
+public:
+    static constexpr uint32_t PIECE_DIM = 64u;
+
+private:
+    struct LevelState {
+        bool valid = false;
+        glm::ivec2 origin { 0, 0 }; // level texel coords of the window's min corner
+        glm::ivec4 pinned { 0, 0, -1, -1 }; // inclusive tile range pinned in the cache
+        // Per cell of the layer, pieces requested and neither uploaded nor cancelled
+        std::vector<uint32_t> pendingPieces;
+    };
+
+    struct Piece {
+        uint32_t level;
+        glm::ivec2 origin;
+        glm::ivec2 size;
+    };
+
+    GLuint texture = 0u;
+    GLuint normalTexture = 0u;
+    uint32_t dim = 0u;
+    GLenum uploadType = GL_UNSIGNED_SHORT;
+    float heightScale = 1.0f;
+    size_t normalOffset = 0u; // byte offset of a piece's normals within its slot
+    size_t uploadBudget = 0u;
+    size_t gpuBytes = 0u;
+
+    const TerrainPyramid* pyramid = nullptr;
+    TileCache* cache = nullptr;
+    std::vector<LevelState> levels;
+    UploadRing ring;
+
+    // Pieces without a ring slot yet, and in-flight pieces indexed by their slot
+    std::deque<Piece> waiting;
+    std::vector<Piece> slotPieces;
+
+    TileDecodePool pool;
+    std::deque<uint32_t> ready; // decoded slots not uploaded yet
+    std::vector<uint32_t> scratchSlots;
+
+    size_t frameUploadBytes = 0u;
+
+    void readRegion(uint32_t level, int32_t x0, int32_t y0, uint32_t w, uint32_t h, uint8_t* dst) const;
+    void decodePiece(const Piece& piece, uint8_t* dst) const;
+    void requestRegion(uint32_t level, int32_t x0, int32_t y0, uint32_t w, uint32_t h);
+    bool overlapsWindow(const Piece& piece) const;
+    uint32_t& pendingPieces(const Piece& piece);
+    void pinWindow(uint32_t level, LevelState& state);
+
+public:
+    // Allocates storage on created texture and pixel-unpack buffer names, which
+    // the caller keeps ownership of. dim must be a power of two multiple of
+    // PIECE_DIM, pyramid and cache must outlive the clipmap. heightScale is the
+    // world height of a normalized sample of 1, used to bake normals. halfFloat
+    // stores F32 pyramids as R16F.
+    void create(GLuint texture, GLuint normalTexture, GLuint uploadBuffer, const TerrainPyramid& pyramid,
+                TileCache& cache, uint32_t levelCount, uint32_t dim, size_t uploadBudget, float heightScale,
+                bool halfFloat = false);
+    void destroy();
+
+    // Re-centers every level on the camera and uploads finished pieces
+    void update(const glm::vec3& cameraPos);
+
+    // Whether level texels [lo, hi] lie in the level's current window and all
+    // of their pieces have been uploaded
+    bool isResident(uint32_t level, const glm::ivec2& lo, const glm::ivec2& hi) const;
+    // Finest level from which every level holds the footprint x footprint
+    // texels around the camera, the coarsest level if none does
+    uint32_t finestResidentLevel(uint32_t footprint) const;
+
+    GLuint getTexture() const { return texture; }
+    GLuint getNormalTexture() const { return normalTexture; }
+    uint32_t getDim() const { return dim; }
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levels.size()); }
+    size_t getFrameUploadBytes() const { return frameUploadBytes; }
+    // Decoded pieces the upload budget held back to a later frame
+    size_t getDeferredPieces() const { return ready.size(); }
+    size_t getGpuBytes() const { return gpuBytes; }
+    TileDecodePool::Stats getDecodeStats() { return pool.getStats(); }
+};
+
+#endif // CLIPMAP_HPP
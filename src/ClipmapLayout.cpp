@@ -0,0 +1,152 @@
+#include <algorithm>
+
+#include "ClipmapLayout.hpp"
+#include "TileIndices.hpp"
+
+static glm::vec2 rotateQuarterTurns(glm::vec2 p, uint32_t rotation)
+{
+    switch (rotation & 3u)
+    {
+        case 1u: return { -p.y,  p.x };
+        case 2u: return { -p.x, -p.y };
+        case 3u: return {  p.y, -p.x };
+        default: return p;
+    }
+}
+
+// Lattice-space bounds of a mesh after rotation
+static void rotatedExtent(glm::ivec2 extent, uint32_t rotation, glm::vec2& lo, glm::vec2& hi)
+{
+    const glm::vec2 a = rotateQuarterTurns(glm::vec2(0.0f), rotation);
+    const glm::vec2 b = rotateQuarterTurns(glm::vec2(extent), rotation);
+    lo = glm::min(a, b);
+    hi = glm::max(a, b);
+}
+
+glm::ivec2 layoutMeshExtent(uint32_t mesh, uint32_t tileDim)
+{
+    const int32_t t = static_cast<int32_t>(tileDim);
+    switch (mesh)
+    {
+        case MESH_TILE: return { t, t };
+        case MESH_ARM:  return { t, 1 };
+        case MESH_TRIM: return { 4 * t + 1, 1 };
+        case MESH_QUAD: return { 1, 1 };
+        default:        return { 4 * t + 2, 0 }; // MESH_SEAM
+    }
+}
+
+std::vector<uint32_t> buildLayoutMesh(uint32_t mesh, uint32_t tileDim, bool strips, uint32_t cacheSize)
+{
+    const uint32_t stride = layoutLatticeWidth(tileDim);
+    const glm::ivec2 extent = layoutMeshExtent(mesh, tileDim);
+
+    std::vector<uint32_t> indices;
+    if (mesh == MESH_SEAM)
+    {
+        // Each triangle spans one edge of the coarser level, its middle vertex
+        // sits on that edge once fully morphed
+        for (uint32_t v = 0u; v + 2u <= static_cast<uint32_t>(extent.x); v += 2u)
+        {
+            if (strips && !indices.empty())
+                indices.push_back(STRIP_RESTART_INDEX);
+            indices.insert(indices.end(), { v, v + 1u, v + 2u });
+        }
+        return indices;
+    }
+
+    if (strips)
+        return buildGridStrips(extent.x, extent.y, stride, gridStripBlockWidth(cacheSize));
+
+    indices = buildGridTriangles(extent.x, extent.y, stride);
+    optimizeVertexCache(indices, stride * layoutLatticeHeight(tileDim), cacheSize);
+    return indices;
+}
+
+void buildClipmapLayout(const glm::vec3& cameraPos, uint32_t tileDim, uint32_t levelCount,
+                        std::vector<TileInstance> (&instances)[MESH_COUNT])
+{
+    for (std::vector<TileInstance>& meshInstances : instances)
+        meshInstances.clear();
+
+    const float t = static_cast<float>(tileDim);
+    const glm::vec2 camera { cameraPos.x, cameraPos.z };
+
+    for (uint32_t level = 0u; level < levelCount; ++level)
+    {
+        const float s = static_cast<float>(1u << level);
+
+        // Puts the rotated mesh's lattice bounds at a world-space min corner
+        auto place = [&](uint32_t mesh, uint32_t rotation, glm::vec2 minCorner) {
+            glm::vec2 lo, hi;
+            rotatedExtent(layoutMeshExtent(mesh, tileDim), rotation, lo, hi);
+            const glm::vec2 offset = minCorner - lo * s;
+            instances[mesh].push_back({ { offset.x, offset.y }, s,
+                                        static_cast<uint16_t>(level), static_cast<uint16_t>(rotation) });
+        };
+
+        const glm::vec2 center = glm::floor(camera / s) * s;
+        const glm::vec2 base = center - 2.0f * t * s;
+
+        // Tiles, the two right/top columns shifted past the filler cross
+        for (uint32_t ty = 0u; ty < 4u; ++ty)
+        {
+            for (uint32_t tx = 0u; tx < 4u; ++tx)
+            {
+                if (level != 0u && (tx == 1u || tx == 2u) && (ty == 1u || ty == 2u))
+                    continue;
+
+                const glm::vec2 cell { static_cast<float>(tx), static_cast<float>(ty) };
+                const glm::vec2 fill { tx >= 2u ? 1.0f : 0.0f, ty >= 2u ? 1.0f : 0.0f };
+                place(MESH_TILE, 0u, base + (cell * t + fill) * s);
+            }
+        }
+
+        // Filler cross, outside the hole
+        place(MESH_ARM, 0u, { center.x + (t + 1.0f) * s, center.y });
+        place(MESH_ARM, 0u, { center.x - 2.0f * t * s, center.y });
+        place(MESH_ARM, 1u, { center.x, center.y + (t + 1.0f) * s });
+        place(MESH_ARM, 1u, { center.x, center.y - 2.0f * t * s });
+
+        // The finest level has no hole, fill the inner half of the cross too
+        if (level == 0u)
+        {
+            place(MESH_ARM, 0u, { center.x + s, center.y });
+            place(MESH_ARM, 0u, { center.x - t * s, center.y });
+            place(MESH_ARM, 1u, { center.x, center.y + s });
+            place(MESH_ARM, 1u, { center.x, center.y - t * s });
+            place(MESH_QUAD, 0u, center);
+        }
+
+        if (level + 1u == levelCount)
+            continue;
+
+        // The hole of the next level is 4T + 2 quads of this one, this level
+        // covers 4T + 1 of them starting on the hole's low side or one after it
+        const float coarse = 2.0f * s;
+        const glm::vec2 hole = glm::floor(camera / coarse) * coarse - t * coarse;
+        const float holeSize = (4.0f * t + 2.0f) * s;
+        const bool lowX = base.x > hole.x;
+        const bool lowY = base.y > hole.y;
+
+        const float trimX = lowX ? hole.x : hole.x + holeSize - s;
+        const float trimY = lowY ? hole.y : hole.y + holeSize - s;
+        place(MESH_TRIM, 0u, { lowX ? hole.x + s : hole.x, trimY });
+        place(MESH_TRIM, 1u, { trimX, lowY ? hole.y + s : hole.y });
+        place(MESH_QUAD, 0u, { trimX, trimY });
+
+        place(MESH_SEAM, 0u, hole);
+        place(MESH_SEAM, 0u, { hole.x, hole.y + holeSize });
+        place(MESH_SEAM, 1u, hole);
+        place(MESH_SEAM, 1u, { hole.x + holeSize, hole.y });
+    }
+}
+
+void layoutInstanceBounds(uint32_t mesh, uint32_t tileDim, const TileInstance& instance, glm::vec2& lo, glm::vec2& hi)
+{
+    rotatedExtent(layoutMeshExtent(mesh, tileDim), instance.rotation, lo, hi);
+
+    const glm::vec2 offset { instance.offset[0], instance.offset[1] };
+    lo = offset + lo * instance.scale;
+    hi = offset + hi * instance.scale;
+}
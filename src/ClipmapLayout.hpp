@@ -0,0 +1,60 @@
+#ifndef CLIPMAP_LAYOUT_HPP
+#define CLIPMAP_LAYOUT_HPP
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief Geometry clipmap footprint after Losasso and Hoppe, with T = tileDim.
+ *
+ * Level L has a vertex spacing of 2^L and covers 4T + 1 quads per side around
+ * its snapped center: 12 T x T tiles (16 at level 0) and a one quad wide
+ * filler cross through the center. The hole left in level L + 1 is 4T + 2
+ * quads of level L, one more than level L covers; an L-shaped trim fills the
+ * remaining row and column on whichever sides the snapping left open, and
+ * degenerate seam triangles along the hole's border cover the T-junctions
+ * with level L + 1. Vertices morph towards level L + 1 before the border.
+ *
+ * Every mesh indexes one shared lattice of vertices (x, y) = y * width + x
+ * and is placed by a TileInstance in quarter turns.
+ */
+enum
+{
+    MESH_TILE = 0, // T x T quads
+    MESH_ARM,      // T x 1 quads, filler cross arm
+    MESH_TRIM,     // 4T + 1 x 1 quads, one leg of an L-shaped trim
+    MESH_QUAD,     // 1 x 1 quad, level 0 center and trim corner
+    MESH_SEAM,     // 2T + 1 degenerate triangles along a 4T + 2 quad edge
+    MESH_COUNT
+};
+
+// Per-instance attributes of the layout meshes
+struct TileInstance {
+    float offset[2];   // world xz of the rotated mesh's lattice origin
+    float scale;       // world units per lattice step, 2^level
+    uint16_t level;    // clipmap level it samples
+    uint16_t rotation; // counter-clockwise quarter turns about the lattice origin
+};
+
+constexpr uint32_t layoutLatticeWidth(uint32_t tileDim) { return 4u * tileDim + 3u; }
+constexpr uint32_t layoutLatticeHeight(uint32_t tileDim) { return tileDim + 1u; }
+
+// Upper bound of instances over all meshes for a level count
+constexpr uint32_t layoutMaxInstances(uint32_t levelCount) { return 9u + 23u * levelCount; }
+
+// Quads covered by a mesh before rotation
+glm::ivec2 layoutMeshExtent(uint32_t mesh, uint32_t tileDim);
+
+// Lattice indices of a mesh, as a triangle list or restart-separated strips
+std::vector<uint32_t> buildLayoutMesh(uint32_t mesh, uint32_t tileDim, bool strips, uint32_t cacheSize);
+
+// Places every level's meshes around the camera, grouped by mesh
+void buildClipmapLayout(const glm::vec3& cameraPos, uint32_t tileDim, uint32_t levelCount,
+                        std::vector<TileInstance> (&instances)[MESH_COUNT]);
+
+// World xz bounds of a placed mesh
+void layoutInstanceBounds(uint32_t mesh, uint32_t tileDim, const TileInstance& instance, glm::vec2& lo, glm::vec2& hi);
+
+#endif // CLIPMAP_LAYOUT_HPP
@@ -0,0 +1,57 @@
+#include <algorithm>
+
+#include "FrameRing.hpp"
+#include "Defines.hpp"
+
+// A region still in use after this long means the GPU stopped making progress
+constexpr GLuint64 FRAME_WAIT_TIMEOUT_NS = 1000000000u;
+
+void FrameRing::create(GLuint buffer, size_t regionSize, uint32_t regionCount)
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniformAlignment = std::max(alignment, 1);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    storageAlignment = std::max(alignment, 1);
+
+    ring.create(buffer, regionSize, regionCount);
+    region = -1;
+    cursor = 0u;
+    peakUsage = 0u;
+
+    LOG("Frame ring: %u regions of %.1f KiB, uniform alignment %zu, storage alignment %zu\n", regionCount,
+        regionSize / 1024.0, uniformAlignment, storageAlignment);
+}
+
+void FrameRing::destroy()
+{
+    ring.destroy();
+    region = -1;
+}
+
+void FrameRing::beginFrame()
+{
+    region = ring.acquire(FRAME_WAIT_TIMEOUT_NS);
+    if (region < 0)
+        EXIT("No frame region retired within " + std::to_string(FRAME_WAIT_TIMEOUT_NS / 1000000u) + " ms");
+    cursor = 0u;
+}
+
+void FrameRing::endFrame()
+{
+    ring.release(static_cast<uint32_t>(region));
+    region = -1;
+}
+
+FrameAllocation FrameRing::allocate(size_t size, size_t alignment)
+{
+    const size_t base = ring.offset(static_cast<uint32_t>(region));
+    const size_t offset = (base + cursor + alignment - 1u) / alignment * alignment;
+    if (offset + size > base + ring.getSlotSize())
+        EXIT("Frame region of " + std::to_string(ring.getSlotSize()) + " bytes cannot fit " + std::to_string(size) +
+             " more after " + std::to_string(cursor));
+
+    cursor = offset + size - base;
+    peakUsage = std::max(peakUsage, cursor);
+    return { ring.data(static_cast<uint32_t>(region)) + (offset - base), offset };
+}
@@ -0,0 +1,54 @@
+#ifndef FRAME_RING_HPP
+#define FRAME_RING_HPP
+
+#include "UploadRing.hpp"
+
+// Part of the current frame's region; offset is from the start of the buffer
+struct FrameAllocation {
+    uint8_t* data;
+    size_t offset;
+};
+
+/**
+ * @brief Streaming memory for everything render() hands the GPU once per frame:
+ * uniform blocks, storage buffers, instances and indirect commands. One
+ * UploadRing slot is the current frame's region and is sub-allocated linearly
+ * between beginFrame() and endFrame(). Data is written once, straight into
+ * mapped memory, and a region is reused only after the fence placed at the end
+ * of its frame has signalled.
+ */
+class FrameRing
+{
+private:
+    UploadRing ring;
+    int32_t region = -1;
+    size_t cursor = 0u;
+    size_t peakUsage = 0u;
+
+    // Binding offsets GL demands of glBindBufferRange
+    size_t uniformAlignment = 256u;
+    size_t storageAlignment = 256u;
+
+public:
+    // Allocates regionCount regions on a created buffer name owned by the caller
+    void create(GLuint buffer, size_t regionSize, uint32_t regionCount);
+    void destroy();
+
+    // Takes the region the GPU finished longest ago, waiting for it if needed
+    void beginFrame();
+    // Fences the region after the frame's last command reading it was issued
+    void endFrame();
+
+    // Any alignment, not only powers of two, so offset / stride addresses an
+    // instance; exits if the region cannot hold the allocation
+    FrameAllocation allocate(size_t size, size_t alignment);
+    FrameAllocation allocateUniform(size_t size) { return allocate(size, uniformAlignment); }
+    FrameAllocation allocateStorage(size_t size) { return allocate(size, storageAlignment); }
+
+    GLuint getBuffer() const { return ring.getBuffer(); }
+    size_t getRegionSize() const { return ring.getSlotSize(); }
+    uint32_t getRegionCount() const { return ring.getSlotCount(); }
+    size_t getPeakUsage() const { return peakUsage; }
+};
+
+#endif // FRAME_RING_HPP
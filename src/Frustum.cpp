@@ -0,0 +1,86 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Frustum.hpp"
+
+void AabbList::clear()
+{
+    loX.clear(); loY.clear(); loZ.clear();
+    hiX.clear(); hiY.clear(); hiZ.clear();
+}
+
+void AabbList::push(const glm::vec3& lo, const glm::vec3& hi)
+{
+    loX.push_back(lo.x); loY.push_back(lo.y); loZ.push_back(lo.z);
+    hiX.push_back(hi.x); hiY.push_back(hi.y); hiZ.push_back(hi.z);
+}
+
+void cullAabbs(const Frustum& frustum, const AabbList& boxes, uint8_t* visible)
+{
+    const size_t count = boxes.size();
+
+    // The corner furthest along a plane's normal takes each component from the
+    // same bound for every box, so pick those arrays once per plane
+    const float* px[6];
+    const float* py[6];
+    const float* pz[6];
+    for (int i = 0; i < 6; ++i)
+    {
+        const glm::vec4& plane = frustum.planes[i];
+        px[i] = plane.x >= 0.0f ? boxes.hiX.data() : boxes.loX.data();
+        py[i] = plane.y >= 0.0f ? boxes.hiY.data() : boxes.loY.data();
+        pz[i] = plane.z >= 0.0f ? boxes.hiZ.data() : boxes.loZ.data();
+    }
+
+    size_t b = 0u;
+
+#if defined(__AVX2__)
+    for (; b + 8u <= count; b += 8u)
+    {
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int i = 0; i < 6; ++i)
+        {
+            const glm::vec4& plane = frustum.planes[i];
+            __m256 d = _mm256_fmadd_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(px[i] + b), _mm256_set1_ps(plane.w));
+            d = _mm256_fmadd_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(py[i] + b), d);
+            d = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(pz[i] + b), d);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        for (size_t k = 0u; k < 8u; ++k)
+            visible[b + k] = static_cast<uint8_t>((mask >> k) & 1);
+    }
+#elif defined(__SSE2__)
+    for (; b + 4u <= count; b += 4u)
+    {
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int i = 0; i < 6; ++i)
+        {
+            const glm::vec4& plane = frustum.planes[i];
+            __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(px[i] + b)), _mm_set1_ps(plane.w));
+            d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(py[i] + b)), d);
+            d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(pz[i] + b)), d);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (size_t k = 0u; k < 4u; ++k)
+            visible[b + k] = static_cast<uint8_t>((mask >> k) & 1);
+    }
+#endif
+
+    for (; b < count; ++b)
+    {
+        bool inside = true;
+        for (int i = 0; i < 6; ++i)
+        {
+            const glm::vec4& plane = frustum.planes[i];
+            inside &= plane.x * px[i][b] + plane.y * py[i][b] + plane.z * pz[i][b] + plane.w >= 0.0f;
+        }
+        visible[b] = inside;
+    }
+}
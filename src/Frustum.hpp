@@ -0,0 +1,63 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief Six inward facing planes (xyz normal, w distance) of a view-projection
+ * matrix, extracted for a [-w, w] depth range. For [0, w] projections the near
+ * plane ends up slightly behind the true one, which keeps tests conservative.
+ */
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+inline Frustum extractFrustum(const glm::mat4& viewProj)
+{
+    // glm is column-major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&viewProj](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0); // left
+    frustum.planes[1] = row(3) - row(0); // right
+    frustum.planes[2] = row(3) + row(1); // bottom
+    frustum.planes[3] = row(3) - row(1); // top
+    frustum.planes[4] = row(3) + row(2); // near
+    frustum.planes[5] = row(3) - row(2); // far
+    return frustum;
+}
+
+// False only if the box lies entirely outside one plane
+inline bool intersectsAabb(const Frustum& frustum, const glm::vec3& lo, const glm::vec3& hi)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        // Corner furthest along the plane normal
+        const glm::vec3 p { plane.x >= 0.0f ? hi.x : lo.x, plane.y >= 0.0f ? hi.y : lo.y, plane.z >= 0.0f ? hi.z : lo.z };
+        if (plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// Boxes as one array per bound component, so planes are tested across many at once
+struct AabbList {
+    std::vector<float> loX, loY, loZ;
+    std::vector<float> hiX, hiY, hiZ;
+
+    size_t size() const { return loX.size(); }
+    void clear();
+    void push(const glm::vec3& lo, const glm::vec3& hi);
+};
+
+/**
+ * @brief intersectsAabb for every box of the list, writing 1 to visible[i] for
+ * boxes that intersect the frustum and 0 for the rest. AVX processes eight boxes
+ * per plane test, SSE four, when available.
+ */
+void cullAabbs(const Frustum& frustum, const AabbList& boxes, uint8_t* visible);
+
+#endif // FRUSTUM_HPP
@@ -0,0 +1,125 @@
+#include "GLResources.hpp"
+
+void Buffer::create()
+{
+    destroy();
+    glCreateBuffers(1, &handle);
+}
+
+void Buffer::destroy()
+{
+    if (handle)
+        glDeleteBuffers(1, &handle);
+    handle = 0u;
+}
+
+void Buffer::storage(size_t size, const void* data, GLbitfield flags) const
+{
+    glNamedBufferStorage(handle, static_cast<GLsizeiptr>(size), data, flags);
+}
+
+void Buffer::data(size_t size, const void* data, GLenum usage) const
+{
+    glNamedBufferData(handle, static_cast<GLsizeiptr>(size), data, usage);
+}
+
+void Buffer::subData(size_t offset, size_t size, const void* data) const
+{
+    glNamedBufferSubData(handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+}
+
+void Buffer::getSubData(size_t offset, size_t size, void* data) const
+{
+    glGetNamedBufferSubData(handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+}
+
+void* Buffer::map(size_t offset, size_t size, GLbitfield access) const
+{
+    return glMapNamedBufferRange(handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), access);
+}
+
+void Buffer::unmap() const
+{
+    glUnmapNamedBuffer(handle);
+}
+
+void Texture::create(GLenum textureTarget)
+{
+    destroy();
+    target = textureTarget;
+    glCreateTextures(target, 1, &handle);
+}
+
+void Texture::destroy()
+{
+    if (handle)
+        glDeleteTextures(1, &handle);
+    handle = 0u;
+    target = GL_NONE;
+}
+
+void Texture::parameter(GLenum name, GLint value) const
+{
+    glTextureParameteri(handle, name, value);
+}
+
+void VertexArray::create()
+{
+    destroy();
+    glCreateVertexArrays(1, &handle);
+}
+
+void VertexArray::destroy()
+{
+    if (handle)
+        glDeleteVertexArrays(1, &handle);
+    handle = 0u;
+}
+
+void VertexArray::attribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint offset, bool normalized) const
+{
+    glEnableVertexArrayAttrib(handle, location);
+    glVertexArrayAttribFormat(handle, location, size, type, normalized ? GL_TRUE : GL_FALSE, offset);
+    glVertexArrayAttribBinding(handle, location, binding);
+}
+
+void VertexArray::integerAttribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint offset) const
+{
+    glEnableVertexArrayAttrib(handle, location);
+    glVertexArrayAttribIFormat(handle, location, size, type, offset);
+    glVertexArrayAttribBinding(handle, location, binding);
+}
+
+void VertexArray::vertexBuffer(GLuint binding, const Buffer& buffer, size_t offset, GLsizei stride, GLuint divisor) const
+{
+    glVertexArrayVertexBuffer(handle, binding, buffer.getHandle(), static_cast<GLintptr>(offset), stride);
+    glVertexArrayBindingDivisor(handle, binding, divisor);
+}
+
+void VertexArray::elementBuffer(const Buffer& buffer) const
+{
+    glVertexArrayElementBuffer(handle, buffer.getHandle());
+}
+
+void Framebuffer::create()
+{
+    destroy();
+    glCreateFramebuffers(1, &handle);
+}
+
+void Framebuffer::destroy()
+{
+    if (handle)
+        glDeleteFramebuffers(1, &handle);
+    handle = 0u;
+}
+
+void Framebuffer::attach(GLenum attachment, const Texture& texture, GLint level) const
+{
+    glNamedFramebufferTexture(handle, attachment, texture.getHandle(), level);
+}
+
+bool Framebuffer::isComplete() const
+{
+    return glCheckNamedFramebufferStatus(handle, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
@@ -0,0 +1,125 @@
+#ifndef GL_RESOURCES_HPP
+#define GL_RESOURCES_HPP
+
+#include <stddef.h>
+#include <utility>
+
+#include <glad/glad.h>
+
+/**
+ * Owning wrappers of GL object names. Objects come from the GL 4.5 glCreate*
+ * functions and are edited through direct state access, so creating and
+ * filling them never disturbs what is bound. Each is move-only and deletes its
+ * name in destroy() or its destructor; globals must be destroyed while the
+ * context is still current, as release() does.
+ */
+
+class Buffer
+{
+private:
+    GLuint handle = 0u;
+
+public:
+    Buffer() = default;
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    Buffer(Buffer&& other) noexcept : handle(std::exchange(other.handle, 0u)) {}
+    Buffer& operator=(Buffer&& other) noexcept { std::swap(handle, other.handle); return *this; }
+    ~Buffer() { destroy(); }
+
+    void create();
+    void destroy();
+
+    // Immutable storage; flags as glBufferStorage
+    void storage(size_t size, const void* data, GLbitfield flags = 0u) const;
+    // Mutable storage, respecified (orphaned) by every call
+    void data(size_t size, const void* data, GLenum usage) const;
+    void subData(size_t offset, size_t size, const void* data) const;
+    void getSubData(size_t offset, size_t size, void* data) const;
+
+    void* map(size_t offset, size_t size, GLbitfield access) const;
+    void unmap() const;
+
+    GLuint getHandle() const { return handle; }
+};
+
+class Texture
+{
+private:
+    GLuint handle = 0u;
+    GLenum target = GL_NONE;
+
+public:
+    Texture() = default;
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    Texture(Texture&& other) noexcept
+        : handle(std::exchange(other.handle, 0u)), target(std::exchange(other.target, GLenum(GL_NONE))) {}
+    Texture& operator=(Texture&& other) noexcept
+    {
+        std::swap(handle, other.handle);
+        std::swap(target, other.target);
+        return *this;
+    }
+    ~Texture() { destroy(); }
+
+    // Storage is allocated with allocateTextureStorage(), which accounts it
+    void create(GLenum target);
+    void destroy();
+
+    void parameter(GLenum name, GLint value) const;
+
+    GLuint getHandle() const { return handle; }
+    GLenum getTarget() const { return target; }
+};
+
+class VertexArray
+{
+private:
+    GLuint handle = 0u;
+
+public:
+    VertexArray() = default;
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+    VertexArray(VertexArray&& other) noexcept : handle(std::exchange(other.handle, 0u)) {}
+    VertexArray& operator=(VertexArray&& other) noexcept { std::swap(handle, other.handle); return *this; }
+    ~VertexArray() { destroy(); }
+
+    void create();
+    void destroy();
+
+    // Float attribute at location, read from binding at offset within an element
+    void attribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint offset, bool normalized = false) const;
+    // Integer attribute, never converted to float
+    void integerAttribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint offset) const;
+    // Attaches elements of stride bytes from offset to binding; divisor 1 advances per instance
+    void vertexBuffer(GLuint binding, const Buffer& buffer, size_t offset, GLsizei stride, GLuint divisor = 0u) const;
+    void elementBuffer(const Buffer& buffer) const;
+
+    GLuint getHandle() const { return handle; }
+};
+
+class Framebuffer
+{
+private:
+    GLuint handle = 0u;
+
+public:
+    Framebuffer() = default;
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+    Framebuffer(Framebuffer&& other) noexcept : handle(std::exchange(other.handle, 0u)) {}
+    Framebuffer& operator=(Framebuffer&& other) noexcept { std::swap(handle, other.handle); return *this; }
+    ~Framebuffer() { destroy(); }
+
+    void create();
+    void destroy();
+
+    void attach(GLenum attachment, const Texture& texture, GLint level = 0) const;
+    bool isComplete() const;
+
+    GLuint getHandle() const { return handle; }
+};
+
+#endif // GL_RESOURCES_HPP
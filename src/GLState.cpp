@@ -0,0 +1,196 @@
+#include "GLState.hpp"
+
+bool GLState::update(GLuint& cached, GLuint value)
+{
+    if (cached == value)
+    {
+        ++stats.elided;
+        return false;
+    }
+
+    cached = value;
+    ++stats.issued;
+    return true;
+}
+
+GLuint* GLState::findBuffer(GLenum target)
+{
+    switch (target)
+    {
+    case GL_DRAW_INDIRECT_BUFFER:     return &buffers[TARGET_DRAW_INDIRECT];
+    case GL_DISPATCH_INDIRECT_BUFFER: return &buffers[TARGET_DISPATCH_INDIRECT];
+    case GL_UNIFORM_BUFFER:           return &buffers[TARGET_UNIFORM];
+    case GL_SHADER_STORAGE_BUFFER:    return &buffers[TARGET_SHADER_STORAGE];
+    default:                          return nullptr;
+    }
+}
+
+GLState::BufferRange* GLState::findRange(GLenum target, GLuint index)
+{
+    if (index >= MAX_BUFFER_BINDINGS)
+        return nullptr;
+    if (target == GL_UNIFORM_BUFFER)
+        return &uniformRanges[index];
+    if (target == GL_SHADER_STORAGE_BUFFER)
+        return &storageRanges[index];
+    return nullptr;
+}
+
+void GLState::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    drawFramebuffer = UNKNOWN;
+    readFramebuffer = UNKNOWN;
+    for (GLuint& texture : textures)
+        texture = UNKNOWN;
+    for (GLuint& buffer : buffers)
+        buffer = UNKNOWN;
+    for (uint32_t index = 0u; index < MAX_BUFFER_BINDINGS; ++index)
+    {
+        uniformRanges[index] = { UNKNOWN, 0, 0 };
+        storageRanges[index] = { UNKNOWN, 0, 0 };
+    }
+    for (GLuint& capability : capabilities)
+        capability = UNKNOWN;
+    polygonModeValue = UNKNOWN;
+    depthFuncValue = UNKNOWN;
+    depthMaskValue = UNKNOWN;
+    blendSource = UNKNOWN;
+    blendDestination = UNKNOWN;
+}
+
+void GLState::useProgram(GLuint handle)
+{
+    if (update(program, handle))
+        glUseProgram(handle);
+}
+
+void GLState::bindVertexArray(GLuint handle)
+{
+    if (update(vertexArray, handle))
+        glBindVertexArray(handle);
+}
+
+void GLState::bindFramebuffer(GLenum target, GLuint handle)
+{
+    if (target == GL_FRAMEBUFFER)
+    {
+        if (drawFramebuffer == handle && readFramebuffer == handle)
+        {
+            ++stats.elided;
+            return;
+        }
+        drawFramebuffer = readFramebuffer = handle;
+        ++stats.issued;
+        glBindFramebuffer(target, handle);
+        return;
+    }
+
+    if (update(target == GL_READ_FRAMEBUFFER ? readFramebuffer : drawFramebuffer, handle))
+        glBindFramebuffer(target, handle);
+}
+
+void GLState::bindTexture(GLuint unit, GLuint handle)
+{
+    // Units beyond the cache are passed through
+    GLuint uncached = UNKNOWN;
+    if (update(unit < MAX_TEXTURE_UNITS ? textures[unit] : uncached, handle))
+        glBindTextureUnit(unit, handle);
+}
+
+void GLState::bindBuffer(GLenum target, GLuint handle)
+{
+    GLuint uncached = UNKNOWN;
+    GLuint* cached = findBuffer(target);
+    if (update(cached ? *cached : uncached, handle))
+        glBindBuffer(target, handle);
+}
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint handle)
+{
+    BufferRange* range = findRange(target, index);
+    if (range && range->buffer == handle && range->size == 0)
+    {
+        ++stats.elided;
+        return;
+    }
+
+    if (range)
+        *range = { handle, 0, 0 };
+    if (GLuint* generic = findBuffer(target))
+        *generic = handle;
+    ++stats.issued;
+    glBindBufferBase(target, index, handle);
+}
+
+void GLState::bindBufferRange(GLenum target, GLuint index, GLuint handle, size_t offset, size_t size)
+{
+    const BufferRange bound = { handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size) };
+    BufferRange* range = findRange(target, index);
+    if (range && range->buffer == bound.buffer && range->offset == bound.offset && range->size == bound.size)
+    {
+        ++stats.elided;
+        return;
+    }
+
+    if (range)
+        *range = bound;
+    if (GLuint* generic = findBuffer(target))
+        *generic = handle;
+    ++stats.issued;
+    glBindBufferRange(target, index, handle, bound.offset, bound.size);
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+    GLuint uncached = UNKNOWN;
+    GLuint* cached = &uncached;
+    switch (capability)
+    {
+    case GL_DEPTH_TEST:                      cached = &capabilities[CAPABILITY_DEPTH_TEST]; break;
+    case GL_BLEND:                           cached = &capabilities[CAPABILITY_BLEND]; break;
+    case GL_CULL_FACE:                       cached = &capabilities[CAPABILITY_CULL_FACE]; break;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX:   cached = &capabilities[CAPABILITY_PRIMITIVE_RESTART_FIXED_INDEX]; break;
+    default: break;
+    }
+
+    if (!update(*cached, enabled ? GL_TRUE : GL_FALSE))
+        return;
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GLState::polygonMode(GLenum mode)
+{
+    if (update(polygonModeValue, mode))
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GLState::depthFunc(GLenum func)
+{
+    if (update(depthFuncValue, func))
+        glDepthFunc(func);
+}
+
+void GLState::depthMask(bool write)
+{
+    if (update(depthMaskValue, write ? GL_TRUE : GL_FALSE))
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::blendFunc(GLenum source, GLenum destination)
+{
+    if (blendSource == source && blendDestination == destination)
+    {
+        ++stats.elided;
+        return;
+    }
+
+    blendSource = source;
+    blendDestination = destination;
+    ++stats.issued;
+    glBlendFunc(source, destination);
+}
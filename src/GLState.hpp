@@ -0,0 +1,116 @@
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <stdint.h>
+
+#include <glad/glad.h>
+
+#include "GLResources.hpp"
+#include "ShaderProgram.hpp"
+
+/**
+ * @brief Cache of the GL bindings and render state the frame loop sets, in
+ * front of the GL calls setting them. A call matching the cached value is
+ * skipped and counted as elided, every other one is issued and recorded.
+ * Objects are edited through direct state access, so nothing else rebinds
+ * behind the cache; code that does must call invalidate() afterwards. Element
+ * buffers are vertex array state and are not tracked.
+ */
+class GLState
+{
+public:
+    static constexpr uint32_t MAX_TEXTURE_UNITS = 16u;
+    static constexpr uint32_t MAX_BUFFER_BINDINGS = 8u; // indexed uniform and storage binding points
+
+    struct Stats {
+        uint64_t issued = 0u;
+        uint64_t elided = 0u;
+    };
+
+private:
+    // Never a valid name or enum, so the first call after invalidate() is issued
+    static constexpr GLuint UNKNOWN = ~0u;
+
+    struct BufferRange {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size; // 0 for a whole-buffer glBindBufferBase binding
+    };
+
+    enum BufferTarget {
+        TARGET_DRAW_INDIRECT,
+        TARGET_DISPATCH_INDIRECT,
+        TARGET_UNIFORM,
+        TARGET_SHADER_STORAGE,
+        TARGET_COUNT
+    };
+
+    enum Capability {
+        CAPABILITY_DEPTH_TEST,
+        CAPABILITY_BLEND,
+        CAPABILITY_CULL_FACE,
+        CAPABILITY_PRIMITIVE_RESTART_FIXED_INDEX,
+        CAPABILITY_COUNT
+    };
+
+    GLuint program = UNKNOWN;
+    GLuint vertexArray = UNKNOWN;
+    GLuint drawFramebuffer = UNKNOWN;
+    GLuint readFramebuffer = UNKNOWN;
+    GLuint textures[MAX_TEXTURE_UNITS];
+    GLuint buffers[TARGET_COUNT];
+    BufferRange uniformRanges[MAX_BUFFER_BINDINGS];
+    BufferRange storageRanges[MAX_BUFFER_BINDINGS];
+    GLuint capabilities[CAPABILITY_COUNT]; // GL_TRUE, GL_FALSE or UNKNOWN
+    GLenum polygonModeValue = UNKNOWN;
+    GLenum depthFuncValue = UNKNOWN;
+    GLuint depthMaskValue = UNKNOWN;
+    GLenum blendSource = UNKNOWN;
+    GLenum blendDestination = UNKNOWN;
+
+    Stats stats;
+
+    // Counts the call, true if it has to be issued
+    bool update(GLuint& cached, GLuint value);
+    // Null for targets and binding points that are not cached
+    GLuint* findBuffer(GLenum target);
+    BufferRange* findRange(GLenum target, GLuint index);
+
+public:
+    GLState() { invalidate(); }
+
+    // Forgets every cached value, e.g. after code outside the cache changed state
+    void invalidate();
+
+    void useProgram(GLuint handle);
+    void useProgram(const ShaderProgram& program) { useProgram(program.getHandle()); }
+    void bindVertexArray(GLuint handle);
+    void bindVertexArray(const VertexArray& array) { bindVertexArray(array.getHandle()); }
+    // GL_FRAMEBUFFER sets both the draw and the read binding
+    void bindFramebuffer(GLenum target, GLuint handle);
+    void bindFramebuffer(GLenum target, const Framebuffer& framebuffer) { bindFramebuffer(target, framebuffer.getHandle()); }
+    // Name 0 unbinds every target of the unit
+    void bindTexture(GLuint unit, GLuint handle);
+    void bindTexture(GLuint unit, const Texture& texture) { bindTexture(unit, texture.getHandle()); }
+
+    void bindBuffer(GLenum target, GLuint handle);
+    void bindBuffer(GLenum target, const Buffer& buffer) { bindBuffer(target, buffer.getHandle()); }
+    // Indexed bindings also replace the target's generic binding, as in GL
+    void bindBufferBase(GLenum target, GLuint index, GLuint handle);
+    void bindBufferBase(GLenum target, GLuint index, const Buffer& buffer) { bindBufferBase(target, index, buffer.getHandle()); }
+    void bindBufferRange(GLenum target, GLuint index, GLuint handle, size_t offset, size_t size);
+
+    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE and GL_PRIMITIVE_RESTART_FIXED_INDEX
+    // are cached, any other capability is always issued
+    void setEnabled(GLenum capability, bool enabled);
+    // Front and back faces alike, the only mode core profiles accept
+    void polygonMode(GLenum mode);
+    void depthFunc(GLenum func);
+    void depthMask(bool write);
+    void blendFunc(GLenum source, GLenum destination);
+
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = {}; }
+};
+
+#endif // GL_STATE_HPP
@@ -0,0 +1,343 @@
+#include <math.h>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "HeightKernels.hpp"
+
+template<typename T>
+static inline T reduce4(DownsampleFilter filter, T a, T b, T c, T d)
+{
+    switch (filter)
+    {
+        case DOWNSAMPLE_MIN:
+            return std::min(std::min(a, b), std::min(c, d));
+        case DOWNSAMPLE_MAX:
+            return std::max(std::max(a, b), std::max(c, d));
+        default:
+            if constexpr (std::is_same_v<T, uint16_t>)
+                return static_cast<uint16_t>((uint32_t(a) + b + c + d + 2u) >> 2u);
+            else
+                return (a + b + c + d) * 0.25f;
+    }
+}
+
+template<typename T>
+static void downsampleRowScalar(DownsampleFilter filter, const T* row0, const T* row1, uint32_t srcWidth,
+                                T* dst, uint32_t xBegin, uint32_t xEnd)
+{
+    for (uint32_t x = xBegin; x < xEnd; ++x)
+    {
+        const uint32_t x0 = 2u * x;
+        const uint32_t x1 = std::min(x0 + 1u, srcWidth - 1u);
+        dst[x] = reduce4(filter, row0[x0], row0[x1], row1[x0], row1[x1]);
+    }
+}
+
+#if defined(__SSE2__)
+
+// 8 outputs from 16 samples of two rows. uint16 lanes are biased by 0x8000 so
+// the signed SSE2 min/max/madd instructions order and sum them correctly.
+static inline __m128i downsample8(DownsampleFilter filter, const uint16_t* row0, const uint16_t* row1)
+{
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i a0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0)),     bias);
+    const __m128i a1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8)), bias);
+    const __m128i b0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row1)),     bias);
+    const __m128i b1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8)), bias);
+
+    if (filter == DOWNSAMPLE_BOX)
+    {
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128i offset = _mm_set1_epi32(4 * 0x8000 + 2);
+        __m128i lo = _mm_add_epi32(_mm_madd_epi16(a0, ones), _mm_madd_epi16(b0, ones));
+        __m128i hi = _mm_add_epi32(_mm_madd_epi16(a1, ones), _mm_madd_epi16(b1, ones));
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, offset), 2);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, offset), 2);
+
+        // Back into the biased signed range for the saturating pack
+        const __m128i half = _mm_set1_epi32(0x8000);
+        return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, half), _mm_sub_epi32(hi, half)), bias);
+    }
+
+    __m128i v0, v1;
+    if (filter == DOWNSAMPLE_MIN)
+    {
+        v0 = _mm_min_epi16(a0, b0);
+        v1 = _mm_min_epi16(a1, b1);
+        v0 = _mm_min_epi16(v0, _mm_srli_epi32(v0, 16));
+        v1 = _mm_min_epi16(v1, _mm_srli_epi32(v1, 16));
+    }
+    else
+    {
+        v0 = _mm_max_epi16(a0, b0);
+        v1 = _mm_max_epi16(a1, b1);
+        v0 = _mm_max_epi16(v0, _mm_srli_epi32(v0, 16));
+        v1 = _mm_max_epi16(v1, _mm_srli_epi32(v1, 16));
+    }
+
+    // Sign-extend the even lanes and pack them
+    v0 = _mm_srai_epi32(_mm_slli_epi32(v0, 16), 16);
+    v1 = _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16);
+    return _mm_xor_si128(_mm_packs_epi32(v0, v1), bias);
+}
+
+static inline __m128 downsample4(DownsampleFilter filter, const float* row0, const float* row1)
+{
+    const __m128 a0 = _mm_loadu_ps(row0);
+    const __m128 a1 = _mm_loadu_ps(row0 + 4);
+    const __m128 b0 = _mm_loadu_ps(row1);
+    const __m128 b1 = _mm_loadu_ps(row1 + 4);
+
+    __m128 v0, v1;
+    switch (filter)
+    {
+        case DOWNSAMPLE_MIN: v0 = _mm_min_ps(a0, b0); v1 = _mm_min_ps(a1, b1); break;
+        case DOWNSAMPLE_MAX: v0 = _mm_max_ps(a0, b0); v1 = _mm_max_ps(a1, b1); break;
+        default:             v0 = _mm_add_ps(a0, b0); v1 = _mm_add_ps(a1, b1); break;
+    }
+
+    const __m128 even = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 odd  = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+
+    switch (filter)
+    {
+        case DOWNSAMPLE_MIN: return _mm_min_ps(even, odd);
+        case DOWNSAMPLE_MAX: return _mm_max_ps(even, odd);
+        default:             return _mm_mul_ps(_mm_add_ps(even, odd), _mm_set1_ps(0.25f));
+    }
+}
+
+#endif // __SSE2__
+
+void downsampleRows(DownsampleFilter filter,
+                    const uint16_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                    uint16_t* dst, size_t dstStride, uint32_t rowBegin, uint32_t rowEnd)
+{
+    const uint32_t dstWidth = downsampledDim(srcWidth);
+
+    for (uint32_t y = rowBegin; y < rowEnd; ++y)
+    {
+        const uint16_t* row0 = src + size_t(2u * y) * srcStride;
+        const uint16_t* row1 = src + size_t(std::min(2u * y + 1u, srcHeight - 1u)) * srcStride;
+        uint16_t* out = dst + size_t(y) * dstStride;
+
+        uint32_t x = 0u;
+#if defined(__SSE2__)
+        for (; x + 8u <= srcWidth / 2u; x += 8u)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), downsample8(filter, row0 + 2u * x, row1 + 2u * x));
+#endif
+        downsampleRowScalar(filter, row0, row1, srcWidth, out, x, dstWidth);
+    }
+}
+
+void downsampleRows(DownsampleFilter filter,
+                    const float* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                    float* dst, size_t dstStride, uint32_t rowBegin, uint32_t rowEnd)
+{
+    const uint32_t dstWidth = downsampledDim(srcWidth);
+
+    for (uint32_t y = rowBegin; y < rowEnd; ++y)
+    {
+        const float* row0 = src + size_t(2u * y) * srcStride;
+        const float* row1 = src + size_t(std::min(2u * y + 1u, srcHeight - 1u)) * srcStride;
+        float* out = dst + size_t(y) * dstStride;
+
+        uint32_t x = 0u;
+#if defined(__SSE2__)
+        for (; x + 4u <= srcWidth / 2u; x += 4u)
+            _mm_storeu_ps(out + x, downsample4(filter, row0 + 2u * x, row1 + 2u * x));
+#endif
+        downsampleRowScalar(filter, row0, row1, srcWidth, out, x, dstWidth);
+    }
+}
+
+void blockMinMax(const uint16_t* src, size_t stride, uint32_t w, uint32_t h, uint16_t& lo, uint16_t& hi)
+{
+    uint16_t mn = 0xFFFFu, mx = 0u;
+    uint32_t x0 = 0u;
+
+#if defined(__SSE2__)
+    if (w >= 8u)
+    {
+        const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+        __m128i vmin = _mm_set1_epi16(0x7FFF);
+        __m128i vmax = _mm_set1_epi16(static_cast<short>(0x8000));
+
+        x0 = w & ~7u;
+        for (uint32_t y = 0u; y < h; ++y)
+        {
+            const uint16_t* row = src + size_t(y) * stride;
+            for (uint32_t x = 0u; x < x0; x += 8u)
+            {
+                const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)), bias);
+                vmin = _mm_min_epi16(vmin, v);
+                vmax = _mm_max_epi16(vmax, v);
+            }
+        }
+
+        alignas(16) int16_t lanesMin[8], lanesMax[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanesMin), _mm_xor_si128(vmin, bias));
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanesMax), _mm_xor_si128(vmax, bias));
+        for (int i = 0; i < 8; ++i)
+        {
+            mn = std::min(mn, static_cast<uint16_t>(lanesMin[i]));
+            mx = std::max(mx, static_cast<uint16_t>(lanesMax[i]));
+        }
+    }
+#endif
+
+    for (uint32_t y = 0u; y < h && x0 < w; ++y)
+    {
+        const uint16_t* row = src + size_t(y) * stride;
+        for (uint32_t x = x0; x < w; ++x)
+        {
+            mn = std::min(mn, row[x]);
+            mx = std::max(mx, row[x]);
+        }
+    }
+
+    lo = mn;
+    hi = mx;
+}
+
+void blockMinMax(const float* src, size_t stride, uint32_t w, uint32_t h, float& lo, float& hi)
+{
+    float mn = src[0], mx = src[0];
+    uint32_t x0 = 0u;
+
+#if defined(__SSE2__)
+    if (w >= 4u)
+    {
+        __m128 vmin = _mm_set1_ps(mn);
+        __m128 vmax = vmin;
+
+        x0 = w & ~3u;
+        for (uint32_t y = 0u; y < h; ++y)
+        {
+            const float* row = src + size_t(y) * stride;
+            for (uint32_t x = 0u; x < x0; x += 4u)
+            {
+                const __m128 v = _mm_loadu_ps(row + x);
+                vmin = _mm_min_ps(vmin, v);
+                vmax = _mm_max_ps(vmax, v);
+            }
+        }
+
+        alignas(16) float lanesMin[4], lanesMax[4];
+        _mm_store_ps(lanesMin, vmin);
+        _mm_store_ps(lanesMax, vmax);
+        for (int i = 0; i < 4; ++i)
+        {
+            mn = std::min(mn, lanesMin[i]);
+            mx = std::max(mx, lanesMax[i]);
+        }
+    }
+#endif
+
+    for (uint32_t y = 0u; y < h && x0 < w; ++y)
+    {
+        const float* row = src + size_t(y) * stride;
+        for (uint32_t x = x0; x < w; ++x)
+        {
+            mn = std::min(mn, row[x]);
+            mx = std::max(mx, row[x]);
+        }
+    }
+
+    lo = mn;
+    hi = mx;
+}
+
+// Rows are centered on the texel, r0 is the row before it
+template<typename T>
+static inline void sobelNormal(const T* r0, const T* r1, const T* r2, float slope, int8_t* out)
+{
+    const float gx = (float(r0[1]) + 2.0f * float(r1[1]) + float(r2[1]))
+                   - (float(r0[-1]) + 2.0f * float(r1[-1]) + float(r2[-1]));
+    const float gz = (float(r2[-1]) + 2.0f * float(r2[0]) + float(r2[1]))
+                   - (float(r0[-1]) + 2.0f * float(r0[0]) + float(r0[1]));
+
+    const float nx = -gx * slope;
+    const float nz = -gz * slope;
+    const float scale = 127.0f / sqrtf(nx * nx + nz * nz + 1.0f);
+    out[0] = static_cast<int8_t>(lrintf(nx * scale));
+    out[1] = static_cast<int8_t>(lrintf(nz * scale));
+}
+
+#if defined(__AVX2__)
+
+static inline __m256 load8(const uint16_t* src)
+{ return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)))); }
+
+static inline __m256 load8(const float* src)
+{ return _mm256_loadu_ps(src); }
+
+// 8 normals, 16 interleaved bytes, from the three rows around them
+template<typename T>
+static inline void sobelNormal8(const T* r0, const T* r1, const T* r2, __m256 slope, int8_t* out)
+{
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 l0 = load8(r0 - 1), c0 = load8(r0), h0 = load8(r0 + 1);
+    const __m256 l1 = load8(r1 - 1),                 h1 = load8(r1 + 1);
+    const __m256 l2 = load8(r2 - 1), c2 = load8(r2), h2 = load8(r2 + 1);
+
+    const __m256 gx = _mm256_sub_ps(_mm256_add_ps(_mm256_fmadd_ps(two, h1, h0), h2),
+                                    _mm256_add_ps(_mm256_fmadd_ps(two, l1, l0), l2));
+    const __m256 gz = _mm256_sub_ps(_mm256_add_ps(_mm256_fmadd_ps(two, c2, l2), h2),
+                                    _mm256_add_ps(_mm256_fmadd_ps(two, c0, l0), h0));
+
+    const __m256 nx = _mm256_mul_ps(gx, slope); // slope is negated by the caller
+    const __m256 nz = _mm256_mul_ps(gz, slope);
+    const __m256 len = _mm256_sqrt_ps(_mm256_fmadd_ps(nx, nx, _mm256_fmadd_ps(nz, nz, _mm256_set1_ps(1.0f))));
+    const __m256 scale = _mm256_div_ps(_mm256_set1_ps(127.0f), len);
+
+    // [x0..x3 z0..z3 | x4..x7 z4..z7] as int16, then regroup and interleave as bytes
+    const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(nx, scale)),
+                                              _mm256_cvtps_epi32(_mm256_mul_ps(nz, scale)));
+    const __m128i lo = _mm256_castsi256_si128(packed);
+    const __m128i hi = _mm256_extracti128_si256(packed, 1);
+    const __m128i bytes = _mm_packs_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(bytes, _mm_srli_si128(bytes, 8)));
+}
+
+#endif // __AVX2__
+
+template<typename T>
+static void sobelNormalsImpl(const T* src, size_t srcStride, uint32_t w, uint32_t h, float slope,
+                             int8_t* dst, size_t dstStride)
+{
+    for (uint32_t y = 0u; y < h; ++y)
+    {
+        const T* r1 = src + size_t(y) * srcStride;
+        const T* r0 = r1 - srcStride;
+        const T* r2 = r1 + srcStride;
+        int8_t* out = dst + 2u * size_t(y) * dstStride;
+
+        uint32_t x = 0u;
+#if defined(__AVX2__)
+        const __m256 negSlope = _mm256_set1_ps(-slope);
+        for (; x + 8u <= w; x += 8u)
+            sobelNormal8(r0 + x, r1 + x, r2 + x, negSlope, out + 2u * x);
+#endif
+        for (; x < w; ++x)
+            sobelNormal(r0 + x, r1 + x, r2 + x, slope, out + 2u * x);
+    }
+}
+
+void sobelNormals(const uint16_t* src, size_t srcStride, uint32_t w, uint32_t h, float slope,
+                  int8_t* dst, size_t dstStride)
+{
+    sobelNormalsImpl(src, srcStride, w, h, slope, dst, dstStride);
+}
+
+void sobelNormals(const float* src, size_t srcStride, uint32_t w, uint32_t h, float slope,
+                  int8_t* dst, size_t dstStride)
+{
+    sobelNormalsImpl(src, srcStride, w, h, slope, dst, dstStride);
+}
@@ -0,0 +1,50 @@
+#ifndef HEIGHT_KERNELS_HPP
+#define HEIGHT_KERNELS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum DownsampleFilter
+{
+    DOWNSAMPLE_BOX = 0,
+    DOWNSAMPLE_MIN,
+    DOWNSAMPLE_MAX,
+};
+
+inline uint32_t downsampledDim(uint32_t dim) { return dim > 1u ? (dim + 1u) / 2u : 1u; }
+
+/**
+ * @brief 2x2 reduction of rows [rowBegin, rowEnd) of the destination level.
+ * Sources with odd dimensions clamp to their last row/column. Strides are in
+ * samples. SSE2 is used for the interior when available.
+ */
+void downsampleRows(DownsampleFilter filter,
+                    const uint16_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                    uint16_t* dst, size_t dstStride, uint32_t rowBegin, uint32_t rowEnd);
+
+void downsampleRows(DownsampleFilter filter,
+                    const float* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                    float* dst, size_t dstStride, uint32_t rowBegin, uint32_t rowEnd);
+
+/**
+ * @brief Min and max of a w x h block, stride in samples. SSE2 is used for
+ * rows of at least one vector when available.
+ */
+void blockMinMax(const uint16_t* src, size_t stride, uint32_t w, uint32_t h, uint16_t& lo, uint16_t& hi);
+void blockMinMax(const float* src, size_t stride, uint32_t w, uint32_t h, float& lo, float& hi);
+
+/**
+ * @brief Sobel normals of a w x h block, packed as the x and z components of the
+ * unit normal in signed bytes; y is always positive and rebuilt from them. src
+ * points at the block's first sample and needs a one-sample border on every
+ * side, strides are in samples and in texels. slope turns a Sobel gradient of
+ * raw samples into rise over run: heightScale / (8 * sampleSpacing), with the
+ * 1/65535 normalization folded into heightScale for uint16 samples. AVX2 is used
+ * for runs of eight texels when available.
+ */
+void sobelNormals(const uint16_t* src, size_t srcStride, uint32_t w, uint32_t h, float slope,
+                  int8_t* dst, size_t dstStride);
+void sobelNormals(const float* src, size_t srcStride, uint32_t w, uint32_t h, float slope,
+                  int8_t* dst, size_t dstStride);
+
+#endif // HEIGHT_KERNELS_HPP
@@ -0,0 +1,70 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stb/stb_image.h>
+
+#include "HeightmapLoader.hpp"
+#include "Defines.hpp"
+
+static bool endsWith(const std::string& str, const std::string& suffix)
+{ return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0; }
+
+void HeightmapFile::open(const std::string& path, uint32_t rawWidth, uint32_t rawHeight)
+{
+    close();
+
+    const bool isR16 = endsWith(path, ".r16");
+    const bool isF32 = endsWith(path, ".f32");
+
+    if (isR16 || isF32)
+    {
+        if (rawWidth == 0u || rawHeight == 0u)
+            EXIT("Raw heightmap " + path + " needs its dimensions");
+
+        const uint32_t format = isF32 ? PYRAMID_FORMAT_F32 : PYRAMID_FORMAT_R16;
+        const size_t expected = pyramidSampleSize(format) * rawWidth * rawHeight;
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            EXIT("Failed to open heightmap " + path);
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != expected)
+            EXIT(path + " is not " + std::to_string(rawWidth) + "x" + std::to_string(rawHeight) +
+                 " (expected " + std::to_string(expected) + " bytes)");
+
+        void* ptr = mmap(nullptr, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+            EXIT("Failed to mmap heightmap " + path);
+        madvise(ptr, expected, MADV_SEQUENTIAL);
+
+        img = { format, rawWidth, rawHeight, ptr };
+        mappedSize = expected;
+        return;
+    }
+
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, channels;
+    stbi_us* data = stbi_load_16(path.c_str(), &width, &height, &channels, 1);
+    if (!data)
+        EXIT("Failed to load heightmap " + path + ": " + stbi_failure_reason());
+
+    img = { PYRAMID_FORMAT_R16, static_cast<uint32_t>(width), static_cast<uint32_t>(height), data };
+}
+
+void HeightmapFile::close()
+{
+    if (img.data)
+    {
+        if (mappedSize)
+            munmap(const_cast<void*>(img.data), mappedSize);
+        else
+            stbi_image_free(const_cast<void*>(img.data));
+    }
+
+    img = {};
+    mappedSize = 0u;
+}
@@ -0,0 +1,42 @@
+#ifndef HEIGHTMAP_LOADER_HPP
+#define HEIGHTMAP_LOADER_HPP
+
+#include <string>
+
+#include "TerrainPyramid.hpp"
+
+// Unowned view of a full-resolution heightmap, row-major and tightly packed
+struct HeightImage {
+    uint32_t format = PYRAMID_FORMAT_R16;
+    uint32_t width  = 0u;
+    uint32_t height = 0u;
+    const void* data = nullptr;
+};
+
+/**
+ * @brief Owns a single-channel source heightmap without intermediate copies.
+ * Headerless little-endian .r16/.f32 files are mmap'd and consumed in place;
+ * anything else is decoded by stbi_load_16 straight to one 16-bit channel and
+ * flipped like the renderer's other images.
+ */
+class HeightmapFile
+{
+private:
+    HeightImage img;
+    size_t mappedSize = 0u; // non-zero when img.data is a mapping rather than an stbi buffer
+
+public:
+    HeightmapFile() = default;
+    HeightmapFile(const HeightmapFile&) = delete;
+    HeightmapFile& operator=(const HeightmapFile&) = delete;
+    ~HeightmapFile() { close(); }
+
+    // rawWidth/rawHeight are only used, and required, for .r16/.f32 files
+    void open(const std::string& path, uint32_t rawWidth = 0u, uint32_t rawHeight = 0u);
+    void close();
+
+    const HeightImage& image() const { return img; }
+    size_t sizeBytes() const { return pyramidSampleSize(img.format) * img.width * img.height; }
+};
+
+#endif // HEIGHTMAP_LOADER_HPP
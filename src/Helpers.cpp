@@ -1,8 +1,8 @@
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 #include <fstream>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
+#include <vector>
 
 #include "Helpers.hpp"
 #include "Defines.hpp"
@@ -37,9 +37,8 @@ static void check_compilation_status(const GLuint shader_handle, const std::stri
    }
 }
 
-static GLuint compile_shader(const std::string shader_path, const uint64_t gl_shader_type)
+static GLuint compile_shader(const std::string& shader_source, const std::string& shader_path, const GLenum gl_shader_type)
 {
-   const std::string shader_source = read_file(shader_path);
    const char* shader_source_cstr = shader_source.c_str();
 
    const GLuint shader_handle = glCreateShader(gl_shader_type);
@@ -62,21 +61,140 @@ static void check_link_status(const GLuint shader_program, const std::string& pr
    }
 }
 
-GLuint createProgram(std::string vertexPath, std::string fragmentPath, std::string programName)
+constexpr const char* PROGRAM_CACHE_DIRECTORY = "../cache";
+
+static ProgramCache g_programCache;
+static bool g_programCacheOpened = false;
+
+struct ShaderStage {
+   GLenum type;
+   std::string path;
+};
+
+// Loads the program from the binary cache, or compiles and links its stages in order and caches the result
+static ShaderProgram build_program(std::initializer_list<ShaderStage> stages, const std::string& programName)
+{
+   const auto start = std::chrono::steady_clock::now();
+   if (!g_programCacheOpened)
+   {
+      g_programCache.open(PROGRAM_CACHE_DIRECTORY);
+      g_programCacheOpened = true;
+   }
+
+   std::vector<std::string> sources;
+   uint64_t key = g_programCache.begin();
+   for (const ShaderStage& stage : stages)
+   {
+      sources.push_back(read_file(stage.path));
+      key = ProgramCache::addStage(key, stage.type, sources.back());
+   }
+
+   GLuint programHandle = g_programCache.load(key);
+   const bool cached = programHandle != 0u;
+   if (!cached)
+   {
+      std::vector<GLuint> shader_handles;
+      size_t s = 0u;
+      for (const ShaderStage& stage : stages)
+         shader_handles.push_back(compile_shader(sources[s++], stage.path, stage.type));
+
+      programHandle = glCreateProgram();
+      glProgramParameteri(programHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      for (GLuint shader_handle : shader_handles)
+         glAttachShader(programHandle, shader_handle);
+      glLinkProgram(programHandle);
+      check_link_status(programHandle, programName);
+
+      for (GLuint shader_handle : shader_handles)
+         glDeleteShader(shader_handle);
+
+      g_programCache.store(key, programHandle);
+   }
+
+   const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+   LOG("Program %s: %s in %.2f ms\n", programName.c_str(), cached ? "loaded from cache" : "compiled", ms);
+   return ShaderProgram(programHandle, programName);
+}
+
+ShaderProgram createProgram(std::string vertexPath, std::string fragmentPath, std::string programName)
+{
+   return build_program({ { GL_VERTEX_SHADER, vertexPath }, { GL_FRAGMENT_SHADER, fragmentPath } }, programName);
+}
+
+ShaderProgram createProgram(std::string vertexPath, std::string controlPath, std::string evaluationPath,
+                            std::string fragmentPath, std::string programName)
+{
+   return build_program({ { GL_VERTEX_SHADER, vertexPath }, { GL_TESS_CONTROL_SHADER, controlPath },
+                          { GL_TESS_EVALUATION_SHADER, evaluationPath }, { GL_FRAGMENT_SHADER, fragmentPath } },
+                        programName);
+}
+
+ShaderProgram createComputeProgram(std::string computePath, std::string programName)
+{
+   return build_program({ { GL_COMPUTE_SHADER, computePath } }, programName);
+}
+
+const ProgramCache::Stats& getProgramCacheStats()
+{
+   return g_programCache.getStats();
+}
+
+static size_t g_textureMemoryBytes = 0u;
+
+size_t textureTexelSize(GLenum internalFormat)
+{
+   switch (internalFormat)
+   {
+      case GL_R8:
+         return 1u;
+      case GL_R16:
+      case GL_R16F:
+      case GL_RG8:
+      case GL_RG8_SNORM:
+         return 2u;
+      case GL_R32F:
+      case GL_DEPTH_COMPONENT32F:
+      case GL_RG16F:
+      case GL_RG16_SNORM:
+      case GL_RGBA8:
+         return 4u;
+      case GL_RG32F:
+      case GL_RGBA16F:
+         return 8u;
+      case GL_RGBA32F:
+         return 16u;
+      default:
+         EXIT("Unsupported internal format " + std::to_string(internalFormat));
+   }
+}
+
+size_t allocateTextureStorage(GLuint texture, GLenum target, GLenum internalFormat,
+                              GLsizei width, GLsizei height, GLsizei depth, GLsizei levels,
+                              const std::string& textureName)
 {
-   const GLuint vertex_shader_handle   = compile_shader(vertexPath, GL_VERTEX_SHADER);
-   const GLuint fragment_shader_handle = compile_shader(fragmentPath, GL_FRAGMENT_SHADER);
+   if (target == GL_TEXTURE_2D_ARRAY)
+      glTextureStorage3D(texture, levels, internalFormat, width, height, depth);
+   else
+      glTextureStorage2D(texture, levels, internalFormat, width, height);
 
-   GLuint programHandle = glCreateProgram();
-   glAttachShader(programHandle, vertex_shader_handle);
-   glAttachShader(programHandle, fragment_shader_handle);
-   glLinkProgram(programHandle);
-   check_link_status(programHandle, programName);
+   size_t bytes = 0u;
+   for (GLsizei level = 0; level < levels; ++level)
+   {
+      const size_t w = std::max(1, width >> level);
+      const size_t h = std::max(1, height >> level);
+      bytes += w * h * depth * textureTexelSize(internalFormat);
+   }
 
-   glDeleteShader(vertex_shader_handle);
-   glDeleteShader(fragment_shader_handle);
+   g_textureMemoryBytes += bytes;
+   LOG("Texture %s: %dx%dx%d, %d level(s), %.2f MiB (total %.2f MiB)\n", textureName.c_str(),
+       width, height, depth, levels, bytes / 1048576.0, g_textureMemoryBytes / 1048576.0);
 
-   return programHandle;
+   return bytes;
+}
+
+size_t getTextureMemoryBytes()
+{
+   return g_textureMemoryBytes;
 }
 
 // GLuint create_texture_2d16(const std::string tex_filepath)
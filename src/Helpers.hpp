@@ -4,27 +4,26 @@
 #include <string>
 
 #include <glad/glad.h>
-#include <glm/gtc/type_ptr.hpp>
 
-GLuint createProgram(std::string vertexPath, std::string fragmentPath, std::string programName);
-
-inline void set_uni_vec2(GLuint programHandle, const std::string& uni_name, const glm::vec2& vec2)
-{ glUniform2fv(glGetUniformLocation(programHandle, uni_name.c_str()), 1, &(vec2[0])); }
-
-inline void set_uni_vec3(GLuint programHandle, const std::string& uni_name, const glm::vec3& vec3)
-{ glUniform3fv(glGetUniformLocation(programHandle, uni_name.c_str()), 1, &(vec3[0])); }
-
-inline void set_uni_vec4(GLuint programHandle, const std::string& uni_name, const glm::vec4& vec4)
-{ glUniform4fv(glGetUniformLocation(programHandle, uni_name.c_str()), 1, &(vec4[0])); }
-
-inline void set_uni_mat4(GLuint programHandle, const std::string& uni_name, const glm::mat4& mat4)
-{ glUniformMatrix4fv(glGetUniformLocation(programHandle, uni_name.c_str()), 1, GL_FALSE, glm::value_ptr(mat4)); }
-
-inline void set_uni_int(GLuint programHandle, const std::string& uni_name, const GLint i)
-{ glUniform1i(glGetUniformLocation(programHandle, uni_name.c_str()), i); }
-
-inline void set_uni_float(GLuint programHandle, const std::string& uni_name, const GLfloat f)
-{ glUniform1f(glGetUniformLocation(programHandle, uni_name.c_str()), f); }
+#include "ProgramCache.hpp"
+#include "ShaderProgram.hpp"
+
+// Load from the program binary cache or compile and link, then reflect; exit on
+// any shader or link error
+ShaderProgram createProgram(std::string vertexPath, std::string fragmentPath, std::string programName);
+ShaderProgram createProgram(std::string vertexPath, std::string controlPath, std::string evaluationPath,
+                            std::string fragmentPath, std::string programName);
+ShaderProgram createComputeProgram(std::string computePath, std::string programName);
+const ProgramCache::Stats& getProgramCacheStats();
+
+size_t textureTexelSize(GLenum internalFormat);
+
+// Immutable storage for a created GL_TEXTURE_2D (depth 1) or GL_TEXTURE_2D_ARRAY;
+// logs and accounts the GPU bytes it reserves, which are returned
+size_t allocateTextureStorage(GLuint texture, GLenum target, GLenum internalFormat,
+                              GLsizei width, GLsizei height, GLsizei depth, GLsizei levels,
+                              const std::string& textureName);
+size_t getTextureMemoryBytes();
 
 // GLuint create_texture_2d(const std::string tex_filepath);
 // GLuint create_texture_2d16(const std::string tex_filepath);
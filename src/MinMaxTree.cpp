@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+#include "MinMaxTree.hpp"
+#include "HeightKernels.hpp"
+#include "Parallel.hpp"
+#include "Defines.hpp"
+
+static HeightRange merge(HeightRange a, HeightRange b)
+{ return { std::min(a.min, b.min), std::max(a.max, b.max) }; }
+
+template<typename T>
+static HeightRange cellRange(const T* src, size_t stride, uint32_t w, uint32_t h)
+{
+    T lo, hi;
+    blockMinMax(src, stride, w, h, lo, hi);
+    if constexpr (std::is_same_v<T, uint16_t>)
+        return { lo / 65535.0f, hi / 65535.0f };
+    else
+        return { lo, hi };
+}
+
+void MinMaxTree::allocate(uint32_t width, uint32_t height)
+{
+    sampleWidth = width;
+    sampleHeight = height;
+    levels.clear();
+
+    uint32_t w = (width + CELL_DIM - 1u) / CELL_DIM;
+    uint32_t h = (height + CELL_DIM - 1u) / CELL_DIM;
+    while (true)
+    {
+        levels.push_back({ w, h, std::vector<HeightRange>(size_t(w) * h) });
+        if (w == 1u && h == 1u)
+            break;
+        w = downsampledDim(w);
+        h = downsampledDim(h);
+    }
+}
+
+/**
+ * @brief Recomputes every ancestor of the level 0 cells [x0, x1) x [y0, y1).
+ */
+void MinMaxTree::propagate(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    for (size_t k = 1u; k < levels.size(); ++k)
+    {
+        const Level& child = levels[k - 1u];
+        Level& parent = levels[k];
+
+        x0 >>= 1u; y0 >>= 1u;
+        x1 = (x1 + 1u) >> 1u; y1 = (y1 + 1u) >> 1u;
+
+        auto reduceRows = [&](size_t begin, size_t end) {
+            for (uint32_t y = begin; y < end; ++y)
+            {
+                const uint32_t cy0 = 2u * y;
+                const uint32_t cy1 = std::min(cy0 + 1u, child.height - 1u);
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    const uint32_t cx0 = 2u * x;
+                    const uint32_t cx1 = std::min(cx0 + 1u, child.width - 1u);
+                    const HeightRange* r0 = &child.cells[size_t(cy0) * child.width];
+                    const HeightRange* r1 = &child.cells[size_t(cy1) * child.width];
+                    parent.cells[size_t(y) * parent.width + x] = merge(merge(r0[cx0], r0[cx1]), merge(r1[cx0], r1[cx1]));
+                }
+            }
+        };
+
+        // Only whole-map updates are worth spreading over threads
+        if (size_t(x1 - x0) * (y1 - y0) >= 64u * 1024u)
+            parallelFor(y1 - y0, [&](size_t begin, size_t end) { reduceRows(y0 + begin, y0 + end); });
+        else
+            reduceRows(y0, y1);
+    }
+}
+
+void MinMaxTree::build(const HeightImage& image)
+{
+    allocate(image.width, image.height);
+    format = image.format;
+
+    Level& base = levels[0];
+    parallelFor(base.height, [&](size_t begin, size_t end) {
+        for (uint32_t cy = begin; cy < end; ++cy)
+        {
+            const uint32_t y = cy * CELL_DIM;
+            const uint32_t h = std::min(CELL_DIM, image.height - y);
+            for (uint32_t cx = 0u; cx < base.width; ++cx)
+            {
+                const uint32_t x = cx * CELL_DIM;
+                const uint32_t w = std::min(CELL_DIM, image.width - x);
+                const size_t offset = size_t(y) * image.width + x;
+
+                base.cells[size_t(cy) * base.width + cx] = image.format == PYRAMID_FORMAT_F32
+                    ? cellRange(static_cast<const float*>(image.data) + offset, image.width, w, h)
+                    : cellRange(static_cast<const uint16_t*>(image.data) + offset, image.width, w, h);
+            }
+        }
+    });
+
+    propagate(0u, 0u, base.width, base.height);
+}
+
+void MinMaxTree::seed(const TerrainPyramid& pyramid)
+{
+    tileSize = pyramid.tileSize();
+    format = pyramid.format();
+    if (tileSize % CELL_DIM != 0u)
+        EXIT("Pyramid tiles must be a multiple of " + std::to_string(CELL_DIM) + " samples");
+
+    const PyramidLevel& level0 = pyramid.level(0u);
+    allocate(level0.width, level0.height);
+
+    Level& base = levels[0];
+    const uint32_t cellsPerTile = tileSize / CELL_DIM;
+
+    for (uint32_t ty = 0u; ty < level0.tilesY; ++ty)
+    {
+        for (uint32_t tx = 0u; tx < level0.tilesX; ++tx)
+        {
+            const PyramidTile& tile = pyramid.tile(0u, tx, ty);
+            const uint32_t cy1 = std::min((ty + 1u) * cellsPerTile, base.height);
+            const uint32_t cx1 = std::min((tx + 1u) * cellsPerTile, base.width);
+
+            for (uint32_t cy = ty * cellsPerTile; cy < cy1; ++cy)
+                std::fill(&base.cells[size_t(cy) * base.width + tx * cellsPerTile],
+                          &base.cells[size_t(cy) * base.width + cx1], HeightRange { tile.minHeight, tile.maxHeight });
+        }
+    }
+
+    propagate(0u, 0u, base.width, base.height);
+}
+
+void MinMaxTree::reduceTile(uint32_t tx, uint32_t ty, const uint8_t* data)
+{
+    const uint32_t cellsPerTile = tileSize / CELL_DIM;
+    PendingTile tile { tx, ty, std::vector<HeightRange>(size_t(cellsPerTile) * cellsPerTile) };
+
+    // Padding samples replicate the last row/column, so reducing whole cells stays exact
+    for (uint32_t cy = 0u; cy < cellsPerTile; ++cy)
+    {
+        for (uint32_t cx = 0u; cx < cellsPerTile; ++cx)
+        {
+            const size_t offset = size_t(cy) * CELL_DIM * tileSize + cx * CELL_DIM;
+            tile.cells[size_t(cy) * cellsPerTile + cx] = format == PYRAMID_FORMAT_F32
+                ? cellRange(reinterpret_cast<const float*>(data) + offset, tileSize, CELL_DIM, CELL_DIM)
+                : cellRange(reinterpret_cast<const uint16_t*>(data) + offset, tileSize, CELL_DIM, CELL_DIM);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.push_back(std::move(tile));
+}
+
+size_t MinMaxTree::applyPending()
+{
+    std::vector<PendingTile> tiles;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        tiles.swap(pending);
+    }
+
+    Level& base = levels[0];
+    const uint32_t cellsPerTile = tileSize / CELL_DIM;
+
+    for (const PendingTile& tile : tiles)
+    {
+        const uint32_t cx0 = tile.tx * cellsPerTile;
+        const uint32_t cy0 = tile.ty * cellsPerTile;
+        const uint32_t cx1 = std::min(cx0 + cellsPerTile, base.width);
+        const uint32_t cy1 = std::min(cy0 + cellsPerTile, base.height);
+
+        for (uint32_t cy = cy0; cy < cy1; ++cy)
+            std::copy_n(&tile.cells[size_t(cy - cy0) * cellsPerTile], cx1 - cx0, &base.cells[size_t(cy) * base.width + cx0]);
+
+        propagate(cx0, cy0, cx1, cy1);
+    }
+
+    return tiles.size();
+}
+
+HeightRange MinMaxTree::query(int32_t x0, int32_t y0, int32_t x1, int32_t y1) const
+{
+    // Outside the map the renderer replicates edge samples, so clamp to the edge cells
+    const int32_t maxX = static_cast<int32_t>(sampleWidth) - 1;
+    const int32_t maxY = static_cast<int32_t>(sampleHeight) - 1;
+    uint32_t cx0 = std::clamp(x0, 0, maxX) / CELL_DIM;
+    uint32_t cy0 = std::clamp(y0, 0, maxY) / CELL_DIM;
+    uint32_t cx1 = std::clamp(x1 - 1, 0, maxX) / CELL_DIM;
+    uint32_t cy1 = std::clamp(y1 - 1, 0, maxY) / CELL_DIM;
+
+    // Coarsen until the footprint is at most 4x4 cells
+    size_t k = 0u;
+    while (k + 1u < levels.size() && (cx1 - cx0 > 3u || cy1 - cy0 > 3u))
+    {
+        cx0 >>= 1u; cy0 >>= 1u; cx1 >>= 1u; cy1 >>= 1u;
+        ++k;
+    }
+
+    const Level& level = levels[k];
+    HeightRange range = level.cells[size_t(cy0) * level.width + cx0];
+    for (uint32_t cy = cy0; cy <= cy1; ++cy)
+        for (uint32_t cx = cx0; cx <= cx1; ++cx)
+            range = merge(range, level.cells[size_t(cy) * level.width + cx]);
+
+    return range;
+}
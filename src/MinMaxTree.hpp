@@ -0,0 +1,72 @@
+#ifndef MIN_MAX_TREE_HPP
+#define MIN_MAX_TREE_HPP
+
+#include <mutex>
+#include <vector>
+
+#include "HeightmapLoader.hpp"
+#include "TerrainPyramid.hpp"
+
+struct HeightRange {
+    float min;
+    float max;
+};
+
+/**
+ * @brief Maximum mipmap over level 0 of a heightmap: level 0 of the tree holds
+ * the height range of every CELL_DIM x CELL_DIM block of samples, every further
+ * level merges 2x2 cells. Heights are normalized like the pyramid tile index.
+ *
+ * A tree seeded from the pyramid index is conservative from the start, with
+ * every cell carrying its tile's range, and tightens as streamed tiles are
+ * reduced (reduceTile, any thread) and applied (applyPending, owner thread).
+ */
+class MinMaxTree
+{
+public:
+    static constexpr uint32_t CELL_DIM = 16u;
+
+private:
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        std::vector<HeightRange> cells;
+    };
+
+    struct PendingTile {
+        uint32_t tx, ty;
+        std::vector<HeightRange> cells; // cellsPerTile^2, row-major
+    };
+
+    std::vector<Level> levels;
+    uint32_t sampleWidth = 0u;
+    uint32_t sampleHeight = 0u;
+    uint32_t tileSize = 0u;
+    uint32_t format = PYRAMID_FORMAT_R16;
+
+    std::mutex pendingMutex;
+    std::vector<PendingTile> pending;
+
+    void allocate(uint32_t width, uint32_t height);
+    void propagate(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+public:
+    // Exact ranges from a fully resident heightmap, computed in parallel
+    void build(const HeightImage& image);
+    // Conservative ranges from the pyramid's per-tile index, no payload is read
+    void seed(const TerrainPyramid& pyramid);
+
+    // Computes a level 0 pyramid tile's cell ranges and queues them for applyPending
+    void reduceTile(uint32_t tx, uint32_t ty, const uint8_t* data);
+    // Writes queued tiles into the tree; returns how many were applied
+    size_t applyPending();
+
+    // Conservative range over level 0 samples [x0, x1) x [y0, y1), clamped to the map
+    HeightRange query(int32_t x0, int32_t y0, int32_t x1, int32_t y1) const;
+
+    bool empty() const { return levels.empty(); }
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levels.size()); }
+    HeightRange getRoot() const { return levels.back().cells[0]; }
+};
+
+#endif // MIN_MAX_TREE_HPP
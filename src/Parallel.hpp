@@ -0,0 +1,43 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+inline unsigned int hardwareThreadCount()
+{ return std::max(1u, std::thread::hardware_concurrency()); }
+
+/**
+ * @brief Splits [0, count) into one contiguous range per hardware thread and
+ * runs fn(begin, end) on each, blocking until all ranges are done. The calling
+ * thread processes the last range itself.
+ */
+template<typename Fn>
+void parallelFor(size_t count, Fn&& fn)
+{
+    const size_t threadCount = std::min<size_t>(hardwareThreadCount(), count);
+    if (threadCount <= 1u)
+    {
+        if (count)
+            fn(size_t(0), count);
+        return;
+    }
+
+    const size_t chunk = (count + threadCount - 1u) / threadCount;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1u);
+
+    size_t begin = 0u;
+    for (size_t i = 0u; i + 1u < threadCount && begin < count; ++i, begin += chunk)
+        workers.emplace_back([&fn, begin, end = std::min(begin + chunk, count)]() { fn(begin, end); });
+
+    if (begin < count)
+        fn(begin, count);
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,151 @@
+#include <errno.h>
+#include <stdio.h>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "ProgramCache.hpp"
+#include "Defines.hpp"
+
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME        = 0x100000001b3ull;
+
+// FNV-1a, stable across runs and builds unlike std::hash
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0u; i < size; ++i)
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    return hash;
+}
+
+static uint64_t hashString(uint64_t hash, const char* string)
+{
+    // Keeps "ab" + "c" apart from "a" + "bc"
+    const std::string value = string ? string : "";
+    const uint64_t length = value.size();
+    hash = hashBytes(hash, &length, sizeof(length));
+    return hashBytes(hash, value.data(), value.size());
+}
+
+void ProgramCache::open(const std::string& cacheDirectory)
+{
+    directory = cacheDirectory;
+    stats = {};
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    enabled = formatCount > 0;
+    if (!enabled)
+    {
+        LOG("Program cache: driver offers no binary formats, disabled\n");
+        return;
+    }
+
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        LOG("Program cache: cannot create %s, disabled\n", directory.c_str());
+        enabled = false;
+        return;
+    }
+
+    driverKey = hashBytes(FNV_OFFSET_BASIS, &PROGRAM_BINARY_VERSION, sizeof(PROGRAM_BINARY_VERSION));
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        driverKey = hashString(driverKey, reinterpret_cast<const char*>(glGetString(name)));
+
+    LOG("Program cache: %s, %d binary format(s)\n", directory.c_str(), formatCount);
+}
+
+uint64_t ProgramCache::addStage(uint64_t key, GLenum stage, const std::string& source)
+{
+    key = hashBytes(key, &stage, sizeof(stage));
+    return hashString(key, source.c_str());
+}
+
+std::string ProgramCache::pathOf(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.tprg", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
+
+GLuint ProgramCache::load(uint64_t key)
+{
+    if (!enabled)
+        return 0u;
+
+    FILE* file = fopen(pathOf(key).c_str(), "rb");
+    if (!file)
+    {
+        ++stats.misses;
+        return 0u;
+    }
+
+    ProgramBinaryHeader header {};
+    std::vector<uint8_t> binary;
+    bool valid = fread(&header, sizeof(header), 1u, file) == 1u && header.magic == PROGRAM_BINARY_MAGIC &&
+                 header.version == PROGRAM_BINARY_VERSION && header.key == key && header.binarySize > 0u;
+    if (valid)
+    {
+        binary.resize(header.binarySize);
+        valid = fread(binary.data(), 1u, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    if (!valid)
+    {
+        ++stats.misses;
+        return 0u;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glDeleteProgram(program);
+        ++stats.rejected;
+        ++stats.misses;
+        return 0u;
+    }
+
+    ++stats.hits;
+    return program;
+}
+
+void ProgramCache::store(uint64_t key, GLuint program)
+{
+    if (!enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<uint8_t> binary(static_cast<size_t>(length));
+    GLenum format = 0u;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    // Written aside and renamed, a crash never leaves a truncated binary under the key
+    const std::string path = pathOf(key);
+    const std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file)
+    {
+        LOG("Program cache: cannot write %s\n", tempPath.c_str());
+        return;
+    }
+
+    const ProgramBinaryHeader header = { PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_VERSION, key, format,
+                                         static_cast<uint32_t>(length) };
+    const bool written = fwrite(&header, sizeof(header), 1u, file) == 1u &&
+                         fwrite(binary.data(), 1u, static_cast<size_t>(length), file) == static_cast<size_t>(length);
+    if (fclose(file) != 0 || !written || rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tempPath.c_str());
+        LOG("Program cache: cannot write %s\n", path.c_str());
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <stdint.h>
+#include <string>
+
+#include <glad/glad.h>
+
+/**
+ * On-disk linked program binary (.tprg), one file per program key. All fields
+ * are native-endian, the file never leaves the machine that wrote it.
+ *
+ *   ProgramBinaryHeader
+ *   binarySize bytes of glGetProgramBinary output
+ */
+
+constexpr uint32_t PROGRAM_BINARY_MAGIC   = 0x47525054u; // "TPRG"
+constexpr uint32_t PROGRAM_BINARY_VERSION = 1u;
+
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format; // GLenum returned by glGetProgramBinary
+    uint32_t binarySize;
+};
+
+/**
+ * @brief Program binaries keyed by a hash of every stage's type and source and
+ * of the driver's vendor, renderer and version strings, so an edited shader or
+ * a driver update yields a new key instead of a stale binary. A binary the
+ * driver rejects is reported as a miss and replaced after the fallback link.
+ * Failing to read or write the cache is never fatal.
+ */
+class ProgramCache
+{
+public:
+    struct Stats {
+        uint32_t hits = 0u;
+        uint32_t misses = 0u;
+        uint32_t rejected = 0u; // binaries present but refused by the driver
+    };
+
+private:
+    std::string directory;
+    uint64_t driverKey = 0u;
+    bool enabled = false;
+    Stats stats;
+
+    std::string pathOf(uint64_t key) const;
+
+public:
+    // Creates the directory if needed; needs a current context. Disabled when
+    // the driver offers no binary format
+    void open(const std::string& directory);
+
+    bool isOpen() const { return enabled; }
+
+    // Folds a stage into a key, start from begin()
+    uint64_t begin() const { return driverKey; }
+    static uint64_t addStage(uint64_t key, GLenum stage, const std::string& source);
+
+    // Returns a linked program, or 0 on a miss
+    GLuint load(uint64_t key);
+    // Stores a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void store(uint64_t key, GLuint program);
+
+    const Stats& getStats() const { return stats; }
+};
+
+#endif // PROGRAM_CACHE_HPP
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <chrono>
+#include <type_traits>
+#include <vector>
+
+#include "PyramidBaker.hpp"
+#include "Parallel.hpp"
+#include "Defines.hpp"
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{ return (value + alignment - 1u) / alignment * alignment; }
+
+static void writeAt(FILE* file, uint64_t offset, const void* data, size_t size, const std::string& path)
+{
+    if (fseeko(file, static_cast<off_t>(offset), SEEK_SET) != 0 || fwrite(data, 1, size, file) != size)
+        EXIT("Failed to write " + path);
+}
+
+template<typename T>
+static float normalizedHeight(T value)
+{
+    if constexpr (std::is_same_v<T, uint16_t>)
+        return value / 65535.0f;
+    else
+        return value;
+}
+
+/**
+ * @brief Copies tile (tx, ty) of a level into dst, replicating the last
+ * row/column into the padding of edge tiles, and returns its height bounds.
+ */
+template<typename T>
+static void extractTile(const T* level, uint32_t width, uint32_t height, uint32_t tileSize,
+                        uint32_t tx, uint32_t ty, T* dst, PyramidTile& entry)
+{
+    T lo = level[0], hi = level[0];
+    bool first = true;
+
+    for (uint32_t y = 0u; y < tileSize; ++y)
+    {
+        const uint32_t srcY = std::min(ty * tileSize + y, height - 1u);
+        const T* row = level + size_t(srcY) * width;
+        T* out = dst + size_t(y) * tileSize;
+
+        const uint32_t x0 = tx * tileSize;
+        const uint32_t validCount = std::min(tileSize, width - x0);
+        std::copy(row + x0, row + x0 + validCount, out);
+        std::fill(out + validCount, out + tileSize, row[width - 1u]);
+
+        // Padding rows/columns are copies, only valid samples feed the bounds
+        if (ty * tileSize + y >= height)
+            continue;
+
+        for (uint32_t x = 0u; x < validCount; ++x)
+        {
+            if (first) { lo = hi = out[x]; first = false; }
+            lo = std::min(lo, out[x]);
+            hi = std::max(hi, out[x]);
+        }
+    }
+
+    entry.minHeight = normalizedHeight(lo);
+    entry.maxHeight = normalizedHeight(hi);
+}
+
+template<typename T>
+static void bake(const HeightImage& src, const std::string& outPath, const BakeSettings& settings)
+{
+    const uint32_t tileSize = settings.tileSize;
+    const size_t tileSamples = size_t(tileSize) * tileSize;
+    const size_t tileBytes = tileSamples * sizeof(T);
+    const uint64_t tileStride = alignUp(tileBytes, PYRAMID_PAYLOAD_ALIGNMENT);
+
+    // Level table and file layout are fully known up front
+    std::vector<PyramidLevel> levels;
+    {
+        uint32_t w = src.width, h = src.height;
+        while (levels.size() < PYRAMID_MAX_LEVELS)
+        {
+            levels.push_back({ w, h, (w + tileSize - 1u) / tileSize, (h + tileSize - 1u) / tileSize, 0u });
+
+            if (settings.levelCount ? levels.size() == settings.levelCount : std::max(w, h) <= tileSize)
+                break;
+            if (w == 1u && h == 1u)
+                break;
+
+            w = downsampledDim(w);
+            h = downsampledDim(h);
+        }
+    }
+
+    uint64_t offset = sizeof(PyramidHeader) + sizeof(PyramidLevel) * levels.size();
+    for (PyramidLevel& level : levels)
+    {
+        level.indexOffset = offset;
+        offset += sizeof(PyramidTile) * level.tilesX * level.tilesY;
+    }
+    uint64_t payloadOffset = alignUp(offset, PYRAMID_PAYLOAD_ALIGNMENT);
+
+    FILE* file = fopen(outPath.c_str(), "wb");
+    if (!file)
+        EXIT("Failed to create " + outPath);
+
+    const T* current = static_cast<const T*>(src.data);
+    std::vector<T> currentStorage, nextStorage;
+    std::vector<T> tileRow;
+
+    for (uint32_t l = 0u; l < levels.size(); ++l)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const PyramidLevel& level = levels[l];
+
+        std::vector<PyramidTile> index(size_t(level.tilesX) * level.tilesY);
+        tileRow.resize(tileSamples * level.tilesX);
+
+        for (uint32_t ty = 0u; ty < level.tilesY; ++ty)
+        {
+            parallelFor(level.tilesX, [&](size_t begin, size_t end) {
+                for (uint32_t tx = begin; tx < end; ++tx)
+                {
+                    PyramidTile& entry = index[size_t(ty) * level.tilesX + tx];
+                    extractTile(current, level.width, level.height, tileSize, tx, ty,
+                                tileRow.data() + tileSamples * tx, entry);
+                    entry.size = tileBytes;
+                    entry.reserved = 0u;
+                }
+            });
+
+            for (uint32_t tx = 0u; tx < level.tilesX; ++tx)
+            {
+                PyramidTile& entry = index[size_t(ty) * level.tilesX + tx];
+                entry.offset = payloadOffset;
+                writeAt(file, payloadOffset, tileRow.data() + tileSamples * tx, tileBytes, outPath);
+                payloadOffset += tileStride;
+            }
+        }
+
+        writeAt(file, level.indexOffset, index.data(), sizeof(PyramidTile) * index.size(), outPath);
+
+        if (l + 1u < levels.size())
+        {
+            const PyramidLevel& next = levels[l + 1u];
+            nextStorage.resize(size_t(next.width) * next.height);
+            parallelFor(next.height, [&](size_t begin, size_t end) {
+                downsampleRows(settings.filter, current, level.width, level.height, level.width,
+                               nextStorage.data(), next.width, begin, end);
+            });
+
+            std::swap(currentStorage, nextStorage);
+            current = currentStorage.data();
+        }
+
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        LOG("  level %u: %ux%u, %u tiles, %.1f ms\n", l, level.width, level.height, level.tilesX * level.tilesY, elapsed.count());
+    }
+
+    const PyramidHeader header {
+        PYRAMID_MAGIC, PYRAMID_VERSION, src.format, src.width, src.height,
+        tileSize, static_cast<uint32_t>(levels.size()), 0u
+    };
+    writeAt(file, 0u, &header, sizeof(header), outPath);
+    writeAt(file, sizeof(header), levels.data(), sizeof(PyramidLevel) * levels.size(), outPath);
+
+    if (fclose(file) != 0)
+        EXIT("Failed to finalize " + outPath);
+}
+
+void bakePyramid(const HeightImage& src, const std::string& outPath, const BakeSettings& settings)
+{
+    if (!src.data || src.width == 0u || src.height == 0u)
+        EXIT("Empty source heightmap");
+    if (settings.tileSize == 0u || (settings.tileSize & (settings.tileSize - 1u)) != 0u)
+        EXIT("Tile size must be a power of two");
+
+    if (src.format == PYRAMID_FORMAT_F32)
+        bake<float>(src, outPath, settings);
+    else
+        bake<uint16_t>(src, outPath, settings);
+}
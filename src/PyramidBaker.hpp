@@ -0,0 +1,23 @@
+#ifndef PYRAMID_BAKER_HPP
+#define PYRAMID_BAKER_HPP
+
+#include <string>
+
+#include "HeightKernels.hpp"
+#include "HeightmapLoader.hpp"
+#include "TerrainPyramid.hpp"
+
+struct BakeSettings {
+    uint32_t tileSize   = 256u;
+    uint32_t levelCount = 0u; // 0 = halve until a level fits in one tile
+    DownsampleFilter filter = DOWNSAMPLE_BOX;
+};
+
+/**
+ * @brief Writes src as a .tpyr file. Each level is reduced from the previous
+ * one and tiled in parallel across all hardware threads, with only two levels
+ * held in memory at a time.
+ */
+void bakePyramid(const HeightImage& src, const std::string& outPath, const BakeSettings& settings);
+
+#endif // PYRAMID_BAKER_HPP
@@ -0,0 +1,109 @@
+#include "ShaderProgram.hpp"
+#include "Defines.hpp"
+
+static bool isOpaqueType(GLenum type)
+{
+    switch (type)
+    {
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D:
+        case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_IMAGE_2D:
+        case GL_IMAGE_3D:
+        case GL_IMAGE_2D_ARRAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static std::string resourceName(GLuint program, GLenum interface, GLint index, GLint length)
+{
+    std::string resource(length, '\0');
+    glGetProgramResourceName(program, interface, index, length, nullptr, resource.data());
+    resource.resize(length > 0 ? length - 1 : 0); // without the terminator
+    return resource;
+}
+
+ShaderProgram::ShaderProgram(GLuint programHandle, const std::string& programName)
+    : handle(programHandle), name(programName)
+{
+    GLint count = 0;
+    glGetProgramInterfaceiv(handle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+    for (GLint index = 0; index < count; ++index)
+    {
+        const GLenum properties[] = { GL_NAME_LENGTH, GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION, GL_BLOCK_INDEX };
+        GLint values[5];
+        glGetProgramResourceiv(handle, GL_UNIFORM, index, 5, properties, 5, nullptr, values);
+
+        // Block members have no location, their block is reflected as a whole
+        if (values[4] != -1)
+            continue;
+
+        // Arrays are reported by their first element
+        std::string uniformName = resourceName(handle, GL_UNIFORM, index, values[0]);
+        if (uniformName.size() > 3u && uniformName.compare(uniformName.size() - 3u, 3u, "[0]") == 0)
+            uniformName.resize(uniformName.size() - 3u);
+
+        uniforms[uniformName] = { values[3], static_cast<GLenum>(values[1]), values[2] };
+    }
+
+    glGetProgramInterfaceiv(handle, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &count);
+    for (GLint index = 0; index < count; ++index)
+    {
+        const GLenum properties[] = { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+        GLint values[3];
+        glGetProgramResourceiv(handle, GL_UNIFORM_BLOCK, index, 3, properties, 3, nullptr, values);
+
+        blocks[resourceName(handle, GL_UNIFORM_BLOCK, index, values[0])] = { values[1], values[2] };
+    }
+}
+
+void ShaderProgram::destroy()
+{
+    if (handle)
+        glDeleteProgram(handle);
+    handle = 0u;
+    uniforms.clear();
+    blocks.clear();
+}
+
+const UniformInfo* ShaderProgram::find(const std::string& uniformName, GLenum type) const
+{
+    const auto it = uniforms.find(uniformName);
+    if (it == uniforms.end())
+    {
+        LOG("Program %s: no active uniform %s\n", name.c_str(), uniformName.c_str());
+        return nullptr;
+    }
+
+    const UniformInfo& info = it->second;
+    if (info.type != type && !(type == GL_INT && isOpaqueType(info.type)))
+        EXIT("Program " + name + ": uniform " + uniformName + " has type " + std::to_string(info.type) +
+             ", not " + std::to_string(type));
+
+    return &info;
+}
+
+void ShaderProgram::checkUniformBlock(const std::string& blockName, GLint binding, size_t size) const
+{
+    const auto it = blocks.find(blockName);
+    if (it == blocks.end())
+        return;
+
+    const UniformBlockInfo& block = it->second;
+    if (block.binding != binding)
+        EXIT("Program " + name + ": block " + blockName + " is at binding " + std::to_string(block.binding) +
+             ", not " + std::to_string(binding));
+    if (static_cast<size_t>(block.dataSize) > size)
+        EXIT("Program " + name + ": block " + blockName + " needs " + std::to_string(block.dataSize) +
+             " bytes, its buffer holds " + std::to_string(size));
+}
@@ -0,0 +1,134 @@
+#ifndef SHADER_PROGRAM_HPP
+#define SHADER_PROGRAM_HPP
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+/**
+ * @brief Typed location of an active uniform of a program's default block.
+ * Values go through glProgramUniform*, so the program need not be bound; an
+ * inactive uniform keeps location -1, which GL ignores.
+ */
+template <typename T>
+class Uniform
+{
+private:
+    GLuint program = 0u;
+    GLint location = -1;
+
+public:
+    Uniform() = default;
+    Uniform(GLuint program, GLint location) : program(program), location(location) {}
+
+    bool isActive() const { return location >= 0; }
+
+    void set(const T& value) const { set(&value, 1); }
+    void set(const T* values, GLsizei count) const;
+};
+
+template <> inline void Uniform<float>::set(const float* values, GLsizei count) const
+{ glProgramUniform1fv(program, location, count, values); }
+
+template <> inline void Uniform<GLint>::set(const GLint* values, GLsizei count) const
+{ glProgramUniform1iv(program, location, count, values); }
+
+template <> inline void Uniform<bool>::set(const bool& value) const
+{ glProgramUniform1i(program, location, value); }
+
+template <> inline void Uniform<glm::vec2>::set(const glm::vec2* values, GLsizei count) const
+{ glProgramUniform2fv(program, location, count, glm::value_ptr(*values)); }
+
+template <> inline void Uniform<glm::vec3>::set(const glm::vec3* values, GLsizei count) const
+{ glProgramUniform3fv(program, location, count, glm::value_ptr(*values)); }
+
+template <> inline void Uniform<glm::vec4>::set(const glm::vec4* values, GLsizei count) const
+{ glProgramUniform4fv(program, location, count, glm::value_ptr(*values)); }
+
+template <> inline void Uniform<glm::mat4>::set(const glm::mat4* values, GLsizei count) const
+{ glProgramUniformMatrix4fv(program, location, count, GL_FALSE, glm::value_ptr(*values)); }
+
+// GL type a uniform must be declared with to take a Uniform<T>, ints also take samplers and images
+template <typename T> constexpr GLenum uniformType();
+template <> constexpr GLenum uniformType<float>()     { return GL_FLOAT; }
+template <> constexpr GLenum uniformType<GLint>()     { return GL_INT; }
+template <> constexpr GLenum uniformType<bool>()      { return GL_BOOL; }
+template <> constexpr GLenum uniformType<glm::vec2>() { return GL_FLOAT_VEC2; }
+template <> constexpr GLenum uniformType<glm::vec3>() { return GL_FLOAT_VEC3; }
+template <> constexpr GLenum uniformType<glm::vec4>() { return GL_FLOAT_VEC4; }
+template <> constexpr GLenum uniformType<glm::mat4>() { return GL_FLOAT_MAT4; }
+
+struct UniformInfo {
+    GLint  location;
+    GLenum type;
+    GLint  arraySize;
+};
+
+struct UniformBlockInfo {
+    GLint binding;
+    GLint dataSize; // minimum buffer size backing the block
+};
+
+/**
+ * @brief A linked program with its active uniforms and uniform blocks
+ * reflected once, so per-frame code sets values through cached handles instead
+ * of looking names up in the driver.
+ */
+class ShaderProgram
+{
+private:
+    GLuint handle = 0u;
+    std::string name;
+    std::unordered_map<std::string, UniformInfo> uniforms; // default block, arrays by their bare name
+    std::unordered_map<std::string, UniformBlockInfo> blocks;
+
+    // Null for an inactive uniform, exits on one declared with another type
+    const UniformInfo* find(const std::string& uniformName, GLenum type) const;
+
+public:
+    ShaderProgram() = default;
+    // Takes ownership of a linked program and reflects its interface
+    ShaderProgram(GLuint handle, const std::string& name);
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+    ShaderProgram(ShaderProgram&& other) noexcept
+        : handle(std::exchange(other.handle, 0u)), name(std::move(other.name)), uniforms(std::move(other.uniforms)),
+          blocks(std::move(other.blocks)) {}
+    ShaderProgram& operator=(ShaderProgram&& other) noexcept
+    {
+        std::swap(handle, other.handle);
+        std::swap(name, other.name);
+        std::swap(uniforms, other.uniforms);
+        std::swap(blocks, other.blocks);
+        return *this;
+    }
+    ~ShaderProgram() { destroy(); }
+
+    void destroy();
+
+    GLuint getHandle() const { return handle; }
+    const std::string& getName() const { return name; }
+
+    template <typename T>
+    Uniform<T> uniform(const std::string& uniformName) const
+    {
+        const UniformInfo* info = find(uniformName, uniformType<T>());
+        return Uniform<T>(handle, info ? info->location : -1);
+    }
+
+    // One-off assignment by name, for values set outside the frame loop
+    template <typename T>
+    void set(const std::string& uniformName, const T& value) const { uniform<T>(uniformName).set(value); }
+
+    template <typename T>
+    void set(const std::string& uniformName, const T* values, GLsizei count) const { uniform<T>(uniformName).set(values, count); }
+
+    // Exits if an active block is not at binding or needs more than size bytes
+    void checkUniformBlock(const std::string& blockName, GLint binding, size_t size) const;
+};
+
+#endif // SHADER_PROGRAM_HPP
@@ -0,0 +1,73 @@
+#include <bit>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TerrainChunks.hpp"
+#include "TerrainPyramid.hpp"
+#include "Defines.hpp"
+
+static_assert(std::endian::native == std::endian::little, "TerrainChunks maps little-endian data directly");
+
+bool TerrainChunks::open(const std::string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ChunkHeader))
+        EXIT("Failed to stat chunks " + path);
+
+    mappingSize = static_cast<size_t>(st.st_size);
+    void* ptr = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+        EXIT("Failed to mmap chunks " + path);
+
+    mapping = static_cast<const uint8_t*>(ptr);
+
+    hdr = reinterpret_cast<const ChunkHeader*>(mapping);
+    if (hdr->magic != CHUNKS_MAGIC || hdr->version != CHUNKS_VERSION)
+        EXIT("Not a v" + std::to_string(CHUNKS_VERSION) + " chunk file: " + path);
+    if (hdr->format >= PYRAMID_FORMAT_COUNT || hdr->chunkSize == 0u || (hdr->chunkSize & (hdr->chunkSize - 1u)) ||
+        hdr->lodCount == 0u || hdr->lodCount > CHUNKS_MAX_LODS || hdr->gridLevels > CHUNKS_MAX_GRID_LEVELS)
+        EXIT("Corrupt chunk header: " + path);
+
+    const size_t chunks = size_t(hdr->chunksX) * hdr->chunksY;
+    const size_t tablesEnd = sizeof(ChunkHeader) + sizeof(ChunkEntry) * chunks + sizeof(ChunkMesh) * chunks * hdr->lodCount;
+    if (tablesEnd > mappingSize ||
+        hdr->vertexOffset + sizeof(ChunkVertex) * size_t(hdr->vertexCount) > mappingSize ||
+        hdr->indexOffset + sizeof(uint32_t) * size_t(hdr->indexCount) > mappingSize)
+        EXIT("Truncated chunk file: " + path);
+
+    entries = reinterpret_cast<const ChunkEntry*>(mapping + sizeof(ChunkHeader));
+    meshes = reinterpret_cast<const ChunkMesh*>(entries + chunks);
+
+    for (size_t i = 0u; i < chunks * hdr->lodCount; ++i)
+    {
+        const ChunkMesh& m = meshes[i];
+        if (size_t(m.firstVertex) + m.vertexCount > hdr->vertexCount || size_t(m.firstIndex) + m.indexCount > hdr->indexCount)
+            EXIT("Corrupt chunk mesh entry " + std::to_string(i) + ": " + path);
+    }
+
+    return true;
+}
+
+void TerrainChunks::close()
+{
+    if (mapping)
+        munmap(const_cast<uint8_t*>(mapping), mappingSize);
+    if (fd >= 0)
+        ::close(fd);
+
+    fd = -1;
+    mapping = nullptr;
+    mappingSize = 0u;
+    hdr = nullptr;
+    entries = nullptr;
+    meshes = nullptr;
+}
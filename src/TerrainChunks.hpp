@@ -0,0 +1,109 @@
+#ifndef TERRAIN_CHUNKS_HPP
+#define TERRAIN_CHUNKS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/**
+ * On-disk chunked LOD meshes (.tchk). All fields are little-endian.
+ *
+ *   ChunkHeader
+ *   ChunkEntry[chunksX * chunksY], row-major
+ *   ChunkMesh[chunksX * chunksY * lodCount], a chunk's lods finest first
+ *   ChunkVertex[vertexCount] at ChunkHeader::vertexOffset
+ *   uint32_t indices[indexCount] at ChunkHeader::indexOffset, relative to the mesh's firstVertex
+ *
+ * A chunk covers chunkSize x chunkSize quads of level 0 samples, its meshes are
+ * right-triangulated (RTIN) simplifications of its chunkSize + 1 samples per
+ * side, each within a maximum vertical error. Every mesh ends in a skirt hanging
+ * from its border down to the chunk's minimum height, which hides the cracks to
+ * neighbours of any other lod or representation.
+ */
+
+constexpr uint32_t CHUNKS_MAGIC           = 0x4B484354u; // "TCHK"
+constexpr uint32_t CHUNKS_VERSION         = 1u;
+constexpr uint32_t CHUNKS_MAX_LODS        = 16u;
+constexpr uint32_t CHUNKS_MAX_GRID_LEVELS = 16u;
+constexpr uint64_t CHUNKS_DATA_ALIGNMENT  = 4096u;
+
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;     // PyramidFormat of the source, heights are normalized like the pyramid index
+    uint32_t width;
+    uint32_t height;
+    uint32_t chunkSize;  // quads per side, a power of two
+    uint32_t chunksX;
+    uint32_t chunksY;
+    uint32_t lodCount;
+    uint32_t gridLevels; // valid entries of ChunkEntry::gridErrors, spacings 1 to chunkSize
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+};
+
+struct ChunkEntry {
+    float minHeight;
+    float maxHeight;
+    float gridErrors[CHUNKS_MAX_GRID_LEVELS]; // error of a regular grid with a spacing of 2^level samples
+};
+
+struct ChunkMesh {
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float    error;      // measured maximum vertical distance to the samples, normalized
+    uint32_t reserved;
+};
+
+struct ChunkVertex {
+    uint16_t position[2]; // chunk-local sample coordinates, 0 to chunkSize
+    float    height;      // normalized, the chunk's minimum for skirt vertices
+    float    gradient[2]; // normalized rise per sample along x and z
+};
+
+static_assert(sizeof(ChunkHeader) == 64u);
+static_assert(sizeof(ChunkEntry)  == 72u);
+static_assert(sizeof(ChunkMesh)   == 24u);
+static_assert(sizeof(ChunkVertex) == 16u);
+
+/**
+ * @brief Read-only view of a .tchk file, mmap'd like TerrainPyramid. The whole
+ * vertex and index blocks are meant to be uploaded once.
+ */
+class TerrainChunks
+{
+private:
+    int fd = -1;
+    const uint8_t* mapping = nullptr;
+    size_t mappingSize = 0u;
+
+    const ChunkHeader* hdr = nullptr;
+    const ChunkEntry* entries = nullptr;
+    const ChunkMesh* meshes = nullptr;
+
+public:
+    TerrainChunks() = default;
+    TerrainChunks(const TerrainChunks&) = delete;
+    TerrainChunks& operator=(const TerrainChunks&) = delete;
+    ~TerrainChunks() { close(); }
+
+    // Returns false if the file does not exist, exits on a malformed file.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+
+    const ChunkHeader& header() const { return *hdr; }
+    uint32_t chunkCount() const { return hdr->chunksX * hdr->chunksY; }
+    const ChunkEntry& entry(uint32_t chunk) const { return entries[chunk]; }
+    const ChunkMesh& mesh(uint32_t chunk, uint32_t lod) const { return meshes[size_t(chunk) * hdr->lodCount + lod]; }
+
+    const ChunkVertex* vertices() const { return reinterpret_cast<const ChunkVertex*>(mapping + hdr->vertexOffset); }
+    const uint32_t* indices() const { return reinterpret_cast<const uint32_t*>(mapping + hdr->indexOffset); }
+};
+
+#endif // TERRAIN_CHUNKS_HPP
@@ -0,0 +1,117 @@
+#include <bit>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TerrainPyramid.hpp"
+#include "HeightKernels.hpp"
+#include "Defines.hpp"
+
+static_assert(std::endian::native == std::endian::little, "TerrainPyramid maps little-endian payloads directly");
+
+bool TerrainPyramid::open(const std::string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PyramidHeader))
+        EXIT("Failed to stat pyramid " + path);
+
+    mappingSize = static_cast<size_t>(st.st_size);
+    void* ptr = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+        EXIT("Failed to mmap pyramid " + path);
+
+    mapping = static_cast<const uint8_t*>(ptr);
+    madvise(ptr, mappingSize, MADV_RANDOM);
+
+    hdr = reinterpret_cast<const PyramidHeader*>(mapping);
+    if (hdr->magic != PYRAMID_MAGIC || hdr->version != PYRAMID_VERSION)
+        EXIT("Not a v" + std::to_string(PYRAMID_VERSION) + " pyramid: " + path);
+    if (hdr->format >= PYRAMID_FORMAT_COUNT || hdr->tileSize == 0u ||
+        hdr->levelCount == 0u || hdr->levelCount > PYRAMID_MAX_LEVELS)
+        EXIT("Corrupt pyramid header: " + path);
+
+    const size_t levelTableEnd = sizeof(PyramidHeader) + sizeof(PyramidLevel) * hdr->levelCount;
+    if (levelTableEnd > mappingSize)
+        EXIT("Truncated pyramid level table: " + path);
+    levels = reinterpret_cast<const PyramidLevel*>(mapping + sizeof(PyramidHeader));
+
+    if (hdr->width == 0u || hdr->height == 0u)
+        EXIT("Corrupt pyramid header: " + path);
+
+    uint32_t width = hdr->width;
+    uint32_t height = hdr->height;
+    for (uint32_t l = 0u; l < hdr->levelCount; ++l)
+    {
+        // Every level halves the previous one and is covered by whole tiles, tile
+        // addressing relies on both
+        const PyramidLevel& lvl = levels[l];
+        if (lvl.width != width || lvl.height != height ||
+            lvl.tilesX != (width + hdr->tileSize - 1u) / hdr->tileSize ||
+            lvl.tilesY != (height + hdr->tileSize - 1u) / hdr->tileSize)
+            EXIT("Corrupt pyramid level " + std::to_string(l) + ": " + path);
+        width = downsampledDim(width);
+        height = downsampledDim(height);
+
+        const uint64_t indexBytes = sizeof(PyramidTile) * uint64_t(lvl.tilesX) * lvl.tilesY;
+        if (lvl.indexOffset % alignof(PyramidTile) != 0u || lvl.indexOffset > mappingSize ||
+            indexBytes > mappingSize - lvl.indexOffset)
+            EXIT("Truncated pyramid index for level " + std::to_string(l) + ": " + path);
+
+        // Only the index is validated, the payloads stay untouched until requested
+        const PyramidTile* index = reinterpret_cast<const PyramidTile*>(mapping + lvl.indexOffset);
+        for (size_t i = 0u; i < size_t(lvl.tilesX) * lvl.tilesY; ++i)
+        {
+            if (index[i].size != tileBytes() || index[i].offset % PYRAMID_PAYLOAD_ALIGNMENT != 0u ||
+                index[i].offset > mappingSize || index[i].size > mappingSize - index[i].offset)
+                EXIT("Corrupt pyramid tile entry on level " + std::to_string(l) + ": " + path);
+        }
+    }
+
+    return true;
+}
+
+void TerrainPyramid::close()
+{
+    if (mapping)
+        munmap(const_cast<uint8_t*>(mapping), mappingSize);
+    if (fd >= 0)
+        ::close(fd);
+
+    fd = -1;
+    mapping = nullptr;
+    mappingSize = 0u;
+    hdr = nullptr;
+    levels = nullptr;
+}
+
+const PyramidTile& TerrainPyramid::tile(uint32_t level, uint32_t tx, uint32_t ty) const
+{
+    const PyramidLevel& lvl = levels[level];
+    const PyramidTile* index = reinterpret_cast<const PyramidTile*>(mapping + lvl.indexOffset);
+    return index[size_t(ty) * lvl.tilesX + tx];
+}
+
+const void* TerrainPyramid::tileData(uint32_t level, uint32_t tx, uint32_t ty) const
+{
+    return mapping + tile(level, tx, ty).offset;
+}
+
+void TerrainPyramid::prefetchTile(uint32_t level, uint32_t tx, uint32_t ty) const
+{
+    const PyramidTile& t = tile(level, tx, ty);
+    madvise(const_cast<uint8_t*>(mapping + t.offset), t.size, MADV_WILLNEED);
+}
+
+void TerrainPyramid::releaseTile(uint32_t level, uint32_t tx, uint32_t ty) const
+{
+    const PyramidTile& t = tile(level, tx, ty);
+    madvise(const_cast<uint8_t*>(mapping + t.offset), t.size, MADV_DONTNEED);
+}
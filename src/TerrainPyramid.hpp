@@ -0,0 +1,112 @@
+#ifndef TERRAIN_PYRAMID_HPP
+#define TERRAIN_PYRAMID_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/**
+ * On-disk tiled heightmap pyramid (.tpyr). All fields are little-endian.
+ *
+ *   PyramidHeader
+ *   PyramidLevel[levelCount]
+ *   PyramidTile[tilesX * tilesY] per level, row-major, at PyramidLevel::indexOffset
+ *   tile payloads, tileSize * tileSize samples each, PYRAMID_PAYLOAD_ALIGNMENT aligned
+ *
+ * Level 0 is full resolution and every following level halves both dimensions.
+ * Edge tiles are always stored at full tile size, padded by clamping to the
+ * last valid row/column, so a payload can be addressed without bounds checks.
+ */
+
+constexpr uint32_t PYRAMID_MAGIC             = 0x52595054u; // "TPYR"
+constexpr uint32_t PYRAMID_VERSION           = 1u;
+constexpr uint32_t PYRAMID_MAX_LEVELS        = 16u;
+constexpr uint64_t PYRAMID_PAYLOAD_ALIGNMENT = 4096u;
+
+enum PyramidFormat : uint32_t
+{
+    PYRAMID_FORMAT_R16 = 0, // unorm16
+    PYRAMID_FORMAT_F32 = 1,
+    PYRAMID_FORMAT_COUNT
+};
+
+struct PyramidHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct PyramidLevel {
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint64_t indexOffset;
+};
+
+struct PyramidTile {
+    uint64_t offset;
+    uint32_t size;
+    float    minHeight; // normalized to [0,1] for R16, raw value for F32
+    float    maxHeight;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PyramidHeader) == 32u);
+static_assert(sizeof(PyramidLevel)  == 24u);
+static_assert(sizeof(PyramidTile)   == 24u);
+
+inline size_t pyramidSampleSize(uint32_t format)
+{ return format == PYRAMID_FORMAT_F32 ? sizeof(float) : sizeof(uint16_t); }
+
+/**
+ * @brief Read-only view of a .tpyr file. The file is mmap'd once on open(),
+ * so opening costs the same regardless of dataset size; tile payloads are
+ * only paged in by the kernel when they are first touched.
+ */
+class TerrainPyramid
+{
+private:
+    int fd = -1;
+    const uint8_t* mapping = nullptr;
+    size_t mappingSize = 0u;
+
+    const PyramidHeader* hdr = nullptr;
+    const PyramidLevel* levels = nullptr;
+
+public:
+    TerrainPyramid() = default;
+    TerrainPyramid(const TerrainPyramid&) = delete;
+    TerrainPyramid& operator=(const TerrainPyramid&) = delete;
+    ~TerrainPyramid() { close(); }
+
+    // Returns false if the file does not exist, exits on a malformed file.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+
+    const PyramidHeader& header() const { return *hdr; }
+    const PyramidLevel& level(uint32_t level) const { return levels[level]; }
+    const PyramidTile& tile(uint32_t level, uint32_t tx, uint32_t ty) const;
+
+    uint32_t format() const { return hdr->format; }
+    uint32_t tileSize() const { return hdr->tileSize; }
+    uint32_t levelCount() const { return hdr->levelCount; }
+    size_t sampleSize() const { return pyramidSampleSize(hdr->format); }
+    size_t tileBytes() const { return sampleSize() * hdr->tileSize * hdr->tileSize; }
+
+    // Pointer into the mapping, row-major with a stride of tileSize samples.
+    const void* tileData(uint32_t level, uint32_t tx, uint32_t ty) const;
+
+    // Hint the kernel to start reading a tile / drop its pages once consumed.
+    void prefetchTile(uint32_t level, uint32_t tx, uint32_t ty) const;
+    void releaseTile(uint32_t level, uint32_t tx, uint32_t ty) const;
+};
+
+#endif // TERRAIN_PYRAMID_HPP
@@ -0,0 +1,130 @@
+#include <string.h>
+
+#include "TileCache.hpp"
+
+void TileCache::create(const TerrainPyramid& source, size_t budgetBytes)
+{
+    clear();
+    pyramid = &source;
+    budget = budgetBytes;
+}
+
+void TileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lru.clear();
+    residentBytes = 0u;
+    pinnedTiles = 0u;
+    hits = misses = evictions = 0u;
+}
+
+void TileCache::pinLocked(Entry& entry)
+{
+    if (entry.pins++ == 0u)
+    {
+        ++pinnedTiles;
+        if (!entry.data.empty())
+            lru.erase(entry.lru);
+    }
+}
+
+void TileCache::unpinLocked(uint64_t key)
+{
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.pins == 0u)
+        return;
+
+    Entry& entry = it->second;
+    if (--entry.pins != 0u)
+        return;
+
+    --pinnedTiles;
+    if (entry.data.empty())
+    {
+        entries.erase(it);
+        return;
+    }
+
+    lru.push_front(key);
+    entry.lru = lru.begin();
+    evictLocked();
+}
+
+void TileCache::evictLocked()
+{
+    while (residentBytes > budget && !lru.empty())
+    {
+        const uint64_t key = lru.back();
+        lru.pop_back();
+
+        auto it = entries.find(key);
+        residentBytes -= it->second.data.size();
+        entries.erase(it);
+        ++evictions;
+    }
+}
+
+void TileCache::pin(uint32_t level, uint32_t tx, uint32_t ty)
+{
+    const uint64_t key = makeKey(level, tx, ty);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pinLocked(entries[key]);
+    }
+    pyramid->prefetchTile(level, tx, ty);
+}
+
+void TileCache::unpin(uint32_t level, uint32_t tx, uint32_t ty)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    unpinLocked(makeKey(level, tx, ty));
+}
+
+const uint8_t* TileCache::acquire(uint32_t level, uint32_t tx, uint32_t ty)
+{
+    const uint64_t key = makeKey(level, tx, ty);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = entries[key];
+        pinLocked(entry);
+
+        if (!entry.data.empty())
+        {
+            ++hits;
+            return entry.data.data();
+        }
+        ++misses;
+    }
+
+    // Decode outside the lock; the pin keeps the entry alive meanwhile
+    std::vector<uint8_t> data(pyramid->tileBytes());
+    memcpy(data.data(), pyramid->tileData(level, tx, ty), data.size());
+    pyramid->releaseTile(level, tx, ty);
+    if (onDecode)
+        onDecode(level, tx, ty, data.data());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries[key];
+
+    // Another thread may have decoded the same tile concurrently
+    if (entry.data.empty())
+    {
+        entry.data = std::move(data);
+        residentBytes += entry.data.size();
+        evictLocked();
+    }
+
+    return entry.data.data();
+}
+
+TileCache::Stats TileCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t residentTiles = 0u;
+    for (const auto& [key, entry] : entries)
+        residentTiles += entry.data.empty() ? 0u : 1u;
+
+    return { hits, misses, evictions, residentBytes, residentTiles, pinnedTiles };
+}
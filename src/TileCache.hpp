@@ -0,0 +1,79 @@
+#ifndef TILE_CACHE_HPP
+#define TILE_CACHE_HPP
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "TerrainPyramid.hpp"
+
+/**
+ * @brief CPU copies of pyramid tiles, keyed by (level, x, y), bounded by a byte
+ * budget. Unpinned tiles are evicted least recently used first; pinned tiles are
+ * never evicted, so the budget may be exceeded while everything resident is
+ * pinned. Decoding a tile drops its pages from the pyramid mapping, so the cache
+ * budget bounds the process' heightmap memory. Thread-safe.
+ */
+class TileCache
+{
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t residentBytes;
+        size_t residentTiles;
+        size_t pinnedTiles;
+    };
+
+    // Called on the decoding thread for every freshly decoded tile
+    using DecodeCallback = std::function<void(uint32_t level, uint32_t tx, uint32_t ty, const uint8_t* data)>;
+
+private:
+    struct Entry {
+        std::vector<uint8_t> data; // empty until first acquired
+        uint32_t pins = 0u;
+        std::list<uint64_t>::iterator lru; // valid while unpinned and loaded
+    };
+
+    const TerrainPyramid* pyramid = nullptr;
+    size_t budget = 0u;
+    DecodeCallback onDecode;
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    std::list<uint64_t> lru; // most recently used at the front
+
+    size_t residentBytes = 0u;
+    size_t pinnedTiles = 0u;
+    uint64_t hits = 0u;
+    uint64_t misses = 0u;
+    uint64_t evictions = 0u;
+
+    void pinLocked(Entry& entry);
+    void unpinLocked(uint64_t key);
+    void evictLocked();
+
+public:
+    static uint64_t makeKey(uint32_t level, uint32_t tx, uint32_t ty)
+    { return (uint64_t(level) << 48u) | (uint64_t(ty) << 24u) | tx; }
+
+    void create(const TerrainPyramid& pyramid, size_t budgetBytes);
+    void clear();
+    void setDecodeCallback(DecodeCallback callback) { onDecode = std::move(callback); }
+
+    // Keeps a tile resident until unpinned; decoding is deferred to acquire()
+    void pin(uint32_t level, uint32_t tx, uint32_t ty);
+    void unpin(uint32_t level, uint32_t tx, uint32_t ty);
+
+    // Returns the tile's samples, decoding on a miss. The tile stays pinned
+    // until the matching release().
+    const uint8_t* acquire(uint32_t level, uint32_t tx, uint32_t ty);
+    void release(uint32_t level, uint32_t tx, uint32_t ty) { unpin(level, tx, ty); }
+
+    Stats getStats();
+};
+
+#endif // TILE_CACHE_HPP
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+
+#include "TileDecodePool.hpp"
+
+// Max-heap order: the entry that should run first compares greatest. Coarse
+// levels are what renderers fall back to, so they go first
+bool TileDecodePool::lowerPriority(const Entry& a, const Entry& b)
+{
+    if (a.request.level != b.request.level)
+        return a.request.level < b.request.level;
+    return a.distanceSq > b.distanceSq;
+}
+
+void TileDecodePool::start(uint32_t threadCount, DecodeFn decodeFn)
+{
+    decode = std::move(decodeFn);
+    quit = false;
+    latencies.clear();
+    latencyCursor = 0u;
+
+    for (uint32_t i = 0u; i < std::max(1u, threadCount); ++i)
+        workers.emplace_back(&TileDecodePool::workerMain, this);
+}
+
+void TileDecodePool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+
+    heap.clear();
+    completedIds.clear();
+    inFlight = 0u;
+}
+
+void TileDecodePool::workerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        cv.wait(lock, [this]() { return quit || !heap.empty(); });
+        if (quit)
+            return;
+
+        std::pop_heap(heap.begin(), heap.end(), &TileDecodePool::lowerPriority);
+        const uint32_t id = heap.back().request.id;
+        const auto submitted = heap.back().submitted;
+        heap.pop_back();
+        ++inFlight;
+
+        lock.unlock();
+        decode(id);
+        const float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - submitted).count();
+        lock.lock();
+
+        --inFlight;
+        ++completedCount;
+        completedIds.push_back(id);
+
+        if (latencies.size() < LATENCY_HISTORY)
+            latencies.push_back(elapsedMs);
+        else
+            latencies[latencyCursor] = elapsedMs;
+        latencyCursor = (latencyCursor + 1u) % LATENCY_HISTORY;
+    }
+}
+
+void TileDecodePool::submit(const Request& request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const glm::vec2 d = request.center - focus;
+        heap.push_back({ glm::dot(d, d), std::chrono::steady_clock::now(), request });
+        std::push_heap(heap.begin(), heap.end(), &TileDecodePool::lowerPriority);
+    }
+    cv.notify_one();
+}
+
+void TileDecodePool::setFocus(const glm::vec2& point)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (point == focus)
+        return;
+
+    focus = point;
+    for (Entry& entry : heap)
+    {
+        const glm::vec2 d = entry.request.center - focus;
+        entry.distanceSq = glm::dot(d, d);
+    }
+    std::make_heap(heap.begin(), heap.end(), &TileDecodePool::lowerPriority);
+}
+
+void TileDecodePool::retainIf(const std::function<bool(const Request&)>& wanted, std::vector<uint32_t>& cancelledIds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto kept = std::partition(heap.begin(), heap.end(), [&wanted](const Entry& e) { return wanted(e.request); });
+    if (kept == heap.end())
+        return;
+
+    for (auto it = kept; it != heap.end(); ++it)
+        cancelledIds.push_back(it->request.id);
+
+    cancelledCount += static_cast<uint64_t>(heap.end() - kept);
+    heap.erase(kept, heap.end());
+    std::make_heap(heap.begin(), heap.end(), &TileDecodePool::lowerPriority);
+}
+
+void TileDecodePool::collect(std::vector<uint32_t>& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    out.insert(out.end(), completedIds.begin(), completedIds.end());
+    completedIds.clear();
+}
+
+void TileDecodePool::addCancelled(uint64_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelledCount += count;
+}
+
+TileDecodePool::Stats TileDecodePool::getStats()
+{
+    std::vector<float> sorted;
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats = { heap.size(), inFlight, completedCount, cancelledCount, 0.0f, 0.0f, 0.0f };
+        sorted = latencies;
+    }
+
+    if (!sorted.empty())
+    {
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](float p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1u))]; };
+        stats.latencyP50Ms = percentile(0.50f);
+        stats.latencyP95Ms = percentile(0.95f);
+        stats.latencyP99Ms = percentile(0.99f);
+    }
+
+    return stats;
+}
@@ -0,0 +1,95 @@
+#ifndef TILE_DECODE_POOL_HPP
+#define TILE_DECODE_POOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief Worker threads that decode tile requests off the render thread.
+ * Pending requests are served coarsest clipmap level first, then nearest to the
+ * focus point, and can be cancelled until a worker picks them up. Requests are
+ * identified by a caller-chosen id; completed ids are collected by the caller.
+ */
+class TileDecodePool
+{
+public:
+    struct Request {
+        uint32_t level;
+        glm::vec2 center; // world space xz
+        uint32_t id;
+    };
+
+    struct Stats {
+        size_t queueDepth;
+        size_t inFlight;
+        uint64_t completed;
+        uint64_t cancelled;
+        float latencyP50Ms; // submit to completion, queue wait included
+        float latencyP95Ms;
+        float latencyP99Ms;
+    };
+
+    using DecodeFn = std::function<void(uint32_t id)>;
+
+private:
+    static constexpr size_t LATENCY_HISTORY = 1024u;
+
+    struct Entry {
+        float distanceSq;
+        std::chrono::steady_clock::time_point submitted;
+        Request request;
+    };
+
+    std::vector<std::thread> workers;
+    DecodeFn decode;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Entry> heap;
+    std::vector<uint32_t> completedIds;
+    glm::vec2 focus { 0.0f, 0.0f };
+    bool quit = false;
+
+    size_t inFlight = 0u;
+    uint64_t completedCount = 0u;
+    uint64_t cancelledCount = 0u;
+    std::vector<float> latencies; // ring of the last LATENCY_HISTORY request latencies, ms
+    size_t latencyCursor = 0u;
+
+    static bool lowerPriority(const Entry& a, const Entry& b);
+    void workerMain();
+
+public:
+    TileDecodePool() = default;
+    TileDecodePool(const TileDecodePool&) = delete;
+    TileDecodePool& operator=(const TileDecodePool&) = delete;
+    ~TileDecodePool() { stop(); }
+
+    void start(uint32_t threadCount, DecodeFn decode);
+    void stop();
+
+    void submit(const Request& request);
+
+    // Re-orders pending requests around a new focus point, typically the camera
+    void setFocus(const glm::vec2& focus);
+
+    // Keeps the pending requests for which wanted(request) is true and cancels
+    // the rest, appending their ids
+    void retainIf(const std::function<bool(const Request&)>& wanted, std::vector<uint32_t>& cancelledIds);
+
+    // Moves the ids of finished requests into out
+    void collect(std::vector<uint32_t>& out);
+
+    // Accounts for requests the caller discarded after they were decoded
+    void addCancelled(uint64_t count);
+
+    Stats getStats();
+};
+
+#endif // TILE_DECODE_POOL_HPP
@@ -0,0 +1,199 @@
+#include <algorithm>
+
+#include "TileIndices.hpp"
+
+std::vector<uint32_t> buildGridTriangles(uint32_t width, uint32_t height, uint32_t stride)
+{
+    std::vector<uint32_t> indices;
+    indices.reserve(6u * size_t(width) * height);
+
+    for (uint32_t y = 0u; y < height; ++y)
+    {
+        const uint32_t start = y * stride;
+        const uint32_t end   = start + stride;
+        for (uint32_t x = 0u; x < width; ++x)
+        {
+            indices.insert(indices.end(), { start + x, end + x, start + 1u + x });
+            indices.insert(indices.end(), { end + x, end + 1u + x, start + 1u + x });
+        }
+    }
+
+    return indices;
+}
+
+std::vector<uint32_t> buildGridStrips(uint32_t width, uint32_t height, uint32_t stride, uint32_t blockWidth,
+                                      uint32_t restartIndex)
+{
+    blockWidth = std::clamp(blockWidth, 1u, width);
+
+    std::vector<uint32_t> indices;
+    for (uint32_t x0 = 0u; x0 < width; x0 += blockWidth)
+    {
+        const uint32_t x1 = std::min(x0 + blockWidth, width);
+        for (uint32_t y = 0u; y < height; ++y)
+        {
+            if (!indices.empty())
+                indices.push_back(restartIndex);
+
+            // Alternating rows y and y + 1 give the same winding as buildGridTriangles
+            const uint32_t start = y * stride;
+            const uint32_t end   = start + stride;
+            for (uint32_t x = x0; x <= x1; ++x)
+                indices.insert(indices.end(), { start + x, end + x });
+        }
+    }
+
+    return indices;
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& triangles, uint32_t vertexCount, uint32_t cacheSize)
+{
+    const size_t triangleCount = triangles.size() / 3u;
+
+    // Triangles adjacent to each vertex, as offsets into one flat array
+    std::vector<uint32_t> liveCount(vertexCount, 0u);
+    for (uint32_t v : triangles)
+        ++liveCount[v];
+
+    std::vector<uint32_t> adjacencyStart(vertexCount + 1u, 0u);
+    for (uint32_t v = 0u; v < vertexCount; ++v)
+        adjacencyStart[v + 1u] = adjacencyStart[v] + liveCount[v];
+
+    std::vector<uint32_t> adjacency(triangles.size());
+    std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t t = 0u; t < triangleCount; ++t)
+        for (size_t k = 0u; k < 3u; ++k)
+            adjacency[fill[triangles[3u * t + k]]++] = static_cast<uint32_t>(t);
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0u);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangles.size());
+
+    uint32_t time = cacheSize + 1u;
+    uint32_t cursor = 1u;
+    int64_t fanning = vertexCount ? 0 : -1;
+
+    while (fanning >= 0)
+    {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        for (uint32_t a = adjacencyStart[fanning]; a < adjacencyStart[fanning + 1u]; ++a)
+        {
+            const uint32_t t = adjacency[a];
+            if (emitted[t])
+                continue;
+
+            for (size_t k = 0u; k < 3u; ++k)
+            {
+                const uint32_t v = triangles[3u * t + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --liveCount[v];
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // Next fanning vertex: the oldest candidate that stays cached while its
+        // remaining triangles are emitted, else a dead-end, else any live vertex
+        int64_t best = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (liveCount[v] == 0u)
+                continue;
+
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2u * liveCount[v] <= cacheSize)
+                priority = time - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+
+        if (best < 0)
+        {
+            while (!deadEnd.empty())
+            {
+                const uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveCount[v] > 0u)
+                {
+                    best = v;
+                    break;
+                }
+            }
+        }
+
+        if (best < 0)
+        {
+            for (; cursor < vertexCount; ++cursor)
+            {
+                if (liveCount[cursor] > 0u)
+                {
+                    best = cursor++;
+                    break;
+                }
+            }
+        }
+
+        fanning = best;
+    }
+
+    triangles.swap(output);
+}
+
+VertexCacheStats simulateVertexCache(const std::vector<uint32_t>& indices, bool strips, uint32_t cacheSize,
+                                     uint32_t restartIndex)
+{
+    uint32_t maxIndex = 0u;
+    for (uint32_t v : indices)
+        if (v != restartIndex)
+            maxIndex = std::max(maxIndex, v);
+
+    // A vertex is cached while fewer than cacheSize misses happened since its own
+    std::vector<uint64_t> cacheTime(size_t(maxIndex) + 1u, 0u);
+    uint64_t time = cacheSize + 1u;
+
+    VertexCacheStats stats { 0u, 0u };
+    uint32_t window[3] = {};
+    uint32_t windowSize = 0u;
+
+    for (uint32_t v : indices)
+    {
+        if (strips && v == restartIndex)
+        {
+            windowSize = 0u;
+            continue;
+        }
+
+        if (time - cacheTime[v] > cacheSize)
+        {
+            cacheTime[v] = time++;
+            ++stats.misses;
+        }
+
+        if (strips)
+        {
+            window[0] = window[1];
+            window[1] = window[2];
+            window[2] = v;
+            windowSize = std::min(windowSize + 1u, 3u);
+            if (windowSize == 3u && window[0] != window[1] && window[1] != window[2] && window[0] != window[2])
+                ++stats.triangles;
+        }
+    }
+
+    if (!strips)
+        stats.triangles = indices.size() / 3u;
+
+    return stats;
+}
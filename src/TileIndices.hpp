@@ -0,0 +1,39 @@
+#ifndef TILE_INDICES_HPP
+#define TILE_INDICES_HPP
+
+#include <stdint.h>
+#include <vector>
+
+constexpr uint32_t STRIP_RESTART_INDEX = 0xFFFFFFFFu; // GL_PRIMITIVE_RESTART_FIXED_INDEX for 32-bit indices
+
+// Indices of a width x height quad grid whose vertex (x, y) is y * stride + x,
+// triangle list in row order
+std::vector<uint32_t> buildGridTriangles(uint32_t width, uint32_t height, uint32_t stride);
+
+// Same grid as triangle strips, one strip per row of a column block of
+// blockWidth quads, separated by restartIndex. blockWidth >= width gives
+// whole-row strips; narrower blocks keep the previous row in a small cache.
+std::vector<uint32_t> buildGridStrips(uint32_t width, uint32_t height, uint32_t stride, uint32_t blockWidth,
+                                      uint32_t restartIndex = STRIP_RESTART_INDEX);
+
+// Widest block whose first row, both of its vertex rows missing, still fits a
+// FIFO cache; wider blocks evict the previous row before it is reused
+inline uint32_t gridStripBlockWidth(uint32_t cacheSize) { return cacheSize / 2u - 1u; }
+
+/**
+ * @brief Reorders a triangle list for a post-transform vertex cache of
+ * cacheSize entries (Tipsify, Sander et al. 2007). Linear in the index count.
+ */
+void optimizeVertexCache(std::vector<uint32_t>& triangles, uint32_t vertexCount, uint32_t cacheSize);
+
+struct VertexCacheStats {
+    uint64_t misses;    // vertex shader invocations
+    uint64_t triangles; // non-degenerate triangles
+    double acmr() const { return triangles ? double(misses) / triangles : 0.0; }
+};
+
+// Replays indices through a FIFO cache of cacheSize entries
+VertexCacheStats simulateVertexCache(const std::vector<uint32_t>& indices, bool strips, uint32_t cacheSize,
+                                     uint32_t restartIndex = STRIP_RESTART_INDEX);
+
+#endif // TILE_INDICES_HPP
@@ -0,0 +1,73 @@
+#include "UploadRing.hpp"
+#include "Defines.hpp"
+
+void UploadRing::create(GLuint bufferHandle, size_t size, uint32_t slotCount)
+{
+    buffer = bufferHandle;
+    slotSize = size;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glNamedBufferStorage(buffer, slotSize * slotCount, nullptr, flags);
+    mapped = static_cast<uint8_t*>(glMapNamedBufferRange(buffer, 0, slotSize * slotCount, flags));
+
+    if (!mapped)
+        EXIT("Failed to persistently map upload ring");
+
+    fences.assign(slotCount, nullptr);
+    freeSlots.clear();
+    fencedSlots.clear();
+    for (uint32_t slot = slotCount; slot-- > 0u; )
+        freeSlots.push_back(slot);
+}
+
+void UploadRing::destroy()
+{
+    for (GLsync fence : fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
+    fences.clear();
+    freeSlots.clear();
+    fencedSlots.clear();
+
+    if (mapped)
+        glUnmapNamedBuffer(buffer);
+    mapped = nullptr;
+    buffer = 0u;
+}
+
+int32_t UploadRing::acquire(GLuint64 timeout)
+{
+    if (freeSlots.empty())
+    {
+        // Fences signal in submission order, stop at the first one still pending
+        size_t retired = 0u;
+        for (; retired < fencedSlots.size(); ++retired)
+        {
+            const uint32_t slot = fencedSlots[retired];
+            const GLuint64 wait = retired == 0u ? timeout : 0u;
+            if (glClientWaitSync(fences[slot], wait > 0u ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait) == GL_TIMEOUT_EXPIRED)
+                break;
+
+            glDeleteSync(fences[slot]);
+            fences[slot] = nullptr;
+            freeSlots.push_back(slot);
+        }
+        fencedSlots.erase(fencedSlots.begin(), fencedSlots.begin() + retired);
+    }
+
+    if (freeSlots.empty())
+        return -1;
+
+    const uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    return static_cast<int32_t>(slot);
+}
+
+void UploadRing::release(uint32_t slot)
+{
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fencedSlots.push_back(slot);
+}
@@ -0,0 +1,49 @@
+#ifndef UPLOAD_RING_HPP
+#define UPLOAD_RING_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+ * @brief Fixed-size slots in one persistently, coherently mapped buffer, used
+ * for pixel uploads and per-frame draw data alike. Slots are handed out on the
+ * render thread, may be filled from any thread, and are recycled once the fence
+ * placed after their last GL use has signalled, so the CPU never writes memory
+ * a pending command still reads.
+ */
+class UploadRing
+{
+private:
+    GLuint buffer = 0u;
+    uint8_t* mapped = nullptr;
+    size_t slotSize = 0u;
+
+    std::vector<GLsync> fences;       // per slot, null while not in flight
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> fencedSlots;
+
+public:
+    // Allocates immutable storage on a created buffer name owned by the caller
+    void create(GLuint buffer, size_t slotSize, uint32_t slotCount);
+    void destroy();
+
+    // Returns a slot whose previous contents are no longer in use, or -1; with
+    // none free, waits up to timeout nanoseconds for the oldest one in flight
+    int32_t acquire(GLuint64 timeout = 0u);
+
+    // Fences a slot after the GL commands sourcing it were issued
+    void release(uint32_t slot);
+    // Returns a slot that was never referenced by GL
+    void recycle(uint32_t slot) { freeSlots.push_back(slot); }
+
+    GLuint getBuffer() const { return buffer; }
+    size_t getSlotSize() const { return slotSize; }
+    uint32_t getSlotCount() const { return static_cast<uint32_t>(fences.size()); }
+    uint8_t* data(uint32_t slot) const { return mapped + slotSize * slot; }
+    size_t offset(uint32_t slot) const { return slotSize * slot; }
+};
+
+#endif // UPLOAD_RING_HPP
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "Defines.hpp"
+#include "Parallel.hpp"
+#include "PyramidBaker.hpp"
+
+static void printUsage()
+{
+    LOG("usage: baker <input.png|.r16|.f32> <output.tpyr> [options]\n"
+        "  --size WxH            dimensions of a headerless .r16/.f32 input\n"
+        "  --tile N              tile size in samples, power of two (default 256)\n"
+        "  --levels N            level count (default: until a level fits in one tile)\n"
+        "  --filter box|min|max  downsampling filter (default box)\n");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const std::string inPath  = argv[1];
+    const std::string outPath = argv[2];
+
+    BakeSettings settings;
+    uint32_t rawWidth = 0u, rawHeight = 0u;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--size") && hasValue)
+        {
+            if (sscanf(argv[++i], "%ux%u", &rawWidth, &rawHeight) != 2)
+                EXIT("Malformed --size " + std::string(argv[i]));
+        }
+        else if (!strcmp(argv[i], "--tile") && hasValue)
+            settings.tileSize = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--levels") && hasValue)
+            settings.levelCount = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--filter") && hasValue)
+        {
+            const std::string filter = argv[++i];
+            if (filter == "box")      settings.filter = DOWNSAMPLE_BOX;
+            else if (filter == "min") settings.filter = DOWNSAMPLE_MIN;
+            else if (filter == "max") settings.filter = DOWNSAMPLE_MAX;
+            else EXIT("Unknown filter " + filter);
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    HeightmapFile source;
+    source.open(inPath, rawWidth, rawHeight);
+    const HeightImage& image = source.image();
+
+    LOG("Baking %s (%ux%u %s) on %u threads\n", inPath.c_str(), image.width, image.height,
+        image.format == PYRAMID_FORMAT_F32 ? "f32" : "r16", hardwareThreadCount());
+
+    bakePyramid(image, outPath, settings);
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    LOG("Wrote %s in %.2f s\n", outPath.c_str(), elapsed.count());
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "Defines.hpp"
+#include "Parallel.hpp"
+#include "ChunkBaker.hpp"
+
+static void printUsage()
+{
+    LOG("usage: chunkbaker <input.png|.r16|.f32> <output.tchk> [options]\n"
+        "  --size WxH          dimensions of a headerless .r16/.f32 input\n"
+        "  --chunk N           quads per chunk side, power of two (default 256)\n"
+        "  --errors e0,e1,...  normalized maximum error of every lod, finest first\n"
+        "                      (default 0.0078125,0.015625,0.03125,0.0625,0.125)\n");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const std::string inPath  = argv[1];
+    const std::string outPath = argv[2];
+
+    ChunkBakeSettings settings;
+    uint32_t rawWidth = 0u, rawHeight = 0u;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--size") && hasValue)
+        {
+            if (sscanf(argv[++i], "%ux%u", &rawWidth, &rawHeight) != 2)
+                EXIT("Malformed --size " + std::string(argv[i]));
+        }
+        else if (!strcmp(argv[i], "--chunk") && hasValue)
+            settings.chunkSize = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--errors") && hasValue)
+        {
+            settings.lodErrors.clear();
+            for (const char* token = argv[++i]; *token; )
+            {
+                char* end = nullptr;
+                settings.lodErrors.push_back(strtof(token, &end));
+                if (end == token || (*end && *end != ','))
+                    EXIT("Malformed --errors " + std::string(argv[i]));
+                token = *end ? end + 1 : end;
+            }
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    HeightmapFile source;
+    source.open(inPath, rawWidth, rawHeight);
+    const HeightImage& image = source.image();
+
+    LOG("Meshing %s (%ux%u %s) into %u-quad chunks, %zu lods, on %u threads\n", inPath.c_str(), image.width,
+        image.height, image.format == PYRAMID_FORMAT_F32 ? "f32" : "r16", settings.chunkSize,
+        settings.lodErrors.size(), hardwareThreadCount());
+
+    bakeChunks(image, outPath, settings);
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    LOG("Wrote %s in %.2f s\n", outPath.c_str(), elapsed.count());
+
+    return 0;
+}
@@ -1,8 +1,6 @@
 #include <stdio.h>
 #include <vector>
-
-// #define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
+#include <chrono>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,24 +8,100 @@
 
 #include "Defines.hpp"
 #include "Helpers.hpp"
+#include "GLResources.hpp"
+#include "GLState.hpp"
 #include "Camera.hpp"
+#include "TerrainPyramid.hpp"
+#include "PyramidBaker.hpp"
+#include "TerrainChunks.hpp"
+#include "ChunkBaker.hpp"
+#include "Clipmap.hpp"
+#include "MinMaxTree.hpp"
+#include "Frustum.hpp"
+#include "FrameRing.hpp"
+#include "TileIndices.hpp"
+#include "ClipmapLayout.hpp"
+#include "CdlodTree.hpp"
 
 constexpr uint32_t VIEWER_WIDTH  = 500u;
 constexpr uint32_t VIEWER_HEIGHT = 500u;
-constexpr uint32_t PATCH_RESOLUTION = 64u;
+constexpr uint32_t PATCH_RESOLUTION = 64u; // patches per side of the tessellated terrain
 constexpr uint32_t TERRAIN_WIDTH = 1024; // we will render terrain in 1024x1024 grid
 constexpr uint32_t TILE_DIM = 64u;
 constexpr uint32_t CLIPMAP_LEVELS = 5u;
+constexpr uint32_t CLIPMAP_DIM = 512u; // texels per level, must cover a level plus its trim and seam
+constexpr float    HEIGHT_SCALE = 50.0f; // world height of a normalized sample of 1
+
+constexpr size_t   CLIPMAP_UPLOAD_BUDGET = 1u << 20u; // bytes of texel data uploaded per frame at most
+constexpr size_t   TILE_CACHE_BUDGET = 64u << 20u;     // bytes of decoded tiles kept on the CPU
+
+static_assert((CLIPMAP_DIM & (CLIPMAP_DIM - 1u)) == 0u && CLIPMAP_DIM >= 4u * TILE_DIM + 4u);
+
+// The patch grid spans the area the clipmap layout covers, which the tessellation
+// renderer samples the same levels of
+constexpr float    PATCH_SIZE = float((4u * TILE_DIM) << (CLIPMAP_LEVELS - 1u)) / PATCH_RESOLUTION;
+constexpr float    PATCH_BOUNDS_PAD = float(2u << (CLIPMAP_LEVELS - 1u)); // samples a coarse texel reaches past a patch
+constexpr float    TESSELLATION_ERROR_PIXELS = 1.0f;
+constexpr uint32_t PATCH_VERTEX_COUNT = (PATCH_RESOLUTION + 1u) * (PATCH_RESOLUTION + 1u);
+static_assert(PATCH_VERTEX_COUNT < 0xFFFFu);
+
+// CDLOD nodes sample the clipmap level of their lod, the ranges keep a node and
+// its morph target inside both levels' windows
+constexpr float    CDLOD_RANGE0 = 2.0f * TILE_DIM;
+constexpr float    CDLOD_MORPH_FRACTION = 0.3f;
+
+// Level texels around the camera a renderer samples: the clipmap layout 4T + 3,
+// tessellation 4T, and CDLOD nodes up to a node past their 2T range
+constexpr uint32_t CLIPMAP_FOOTPRINT = 6u * TILE_DIM + 4u;
+static_assert(CLIPMAP_FOOTPRINT <= CLIPMAP_DIM);
+static_assert(CLIPMAP_LEVELS <= CdlodTree::MAX_LODS);
+
+// Chunks switch representation, clipmap grid or baked mesh, once the finer one's
+// error projects below this; grids are used wherever a level holds the chunk resident
+constexpr float    CHUNK_ERROR_PIXELS = 1.0f;
+
+constexpr uint32_t BENCHMARK_FRAMES = 600u; // frames per lap of the benchmark camera path
+
+constexpr uint32_t VERTEX_CACHE_SIZE = 16u; // post-transform cache entries the tile indices are ordered for
+constexpr bool     TILE_STRIPS = false;      // triangle strips with primitive restart instead of a list
+constexpr GLenum   TILE_PRIMITIVE = TILE_STRIPS ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+
+enum
+{
+    TILE_VERTEX_GRID16 = 0, // 2x uint16 grid coordinates per vertex
+    TILE_VERTEX_ID,         // no vertex buffer, coordinates derived from gl_VertexID
+};
+
+constexpr uint32_t TILE_VERTEX_FORMAT = TILE_VERTEX_GRID16;
+constexpr uint32_t TILE_LATTICE_WIDTH = layoutLatticeWidth(TILE_DIM);
+constexpr uint32_t TILE_VERTEX_COUNT = TILE_LATTICE_WIDTH * layoutLatticeHeight(TILE_DIM);
+
+// 16-bit indices while the shared lattice fits below the restart index
+using TileIndex = uint16_t;
+constexpr GLenum TILE_INDEX_TYPE = GL_UNSIGNED_SHORT;
+static_assert(TILE_VERTEX_COUNT < 0xFFFFu);
+
+constexpr uint32_t TILE_INSTANCE_COUNT = layoutMaxInstances(CLIPMAP_LEVELS);
+constexpr uint32_t FRAME_REGIONS = 3u; // frames of streamed uniforms, instances and commands in flight
 
 enum
 {
     PROGRAM_DEFAULT = 0,
+    PROGRAM_HIZ_REDUCE,
+    PROGRAM_HIZ_CULL,
+    PROGRAM_TESSELLATION,
+    PROGRAM_CDLOD,
+    PROGRAM_CHUNK,
     PROGRAM_COUNT
 };
 
 enum
 {
-    TEXTURE_HEIGHTMAP = 0,
+    TEXTURE_CLIPMAP         = 0,
+    TEXTURE_CLIPMAP_NORMALS = 1,
+    TEXTURE_SCENE_COLOR     = 2,
+    TEXTURE_SCENE_DEPTH     = 3,
+    TEXTURE_HIZ             = 4, // farthest depth pyramid of the scene depth
     TEXTURE_COUNT
 };
 
@@ -36,28 +110,202 @@ enum
     VERTEXARRAY_TEST_TRIANGLE = 0,
     VERTEXARRAY_PATCH         = 1,
     VERTEXARRAY_TILE          = 2,
+    VERTEXARRAY_TILE_INDIRECT = 3,
+    VERTEXARRAY_TILE_OCCLUSION = 4,
+    VERTEXARRAY_CDLOD          = 5,
+    VERTEXARRAY_CHUNK          = 6,
+    VERTEXARRAY_CHUNK_GRID     = 7,
     VERTEXARRAY_COUNT
 };
 
 enum 
 {
-    BUFFER_TEST_TRIANGLE = 0,
-    BUFFER_VERTEX_PATCH  = 1,
-    BUFFER_VERTEX_TILE   = 2,
-    BUFFER_INDEX_TILE    = 3,
+    BUFFER_TEST_TRIANGLE  = 0,
+    BUFFER_VERTEX_PATCH   = 1,
+    BUFFER_VERTEX_TILE    = 2,
+    BUFFER_INDEX_TILE     = 3,
+    BUFFER_CLIPMAP_UPLOAD = 4,
+    BUFFER_INSTANCE_TILE  = 5,
+    BUFFER_FRAME_RING     = 6, // per-frame uniforms, instances and commands of every renderer
+    BUFFER_CULL_SURVIVORS  = 7,
+    BUFFER_INDEX_PATCH     = 8,
+    BUFFER_VERTEX_CHUNK    = 9,
+    BUFFER_INDEX_CHUNK     = 10,
+    BUFFER_INDEX_CHUNK_GRID = 11,
     BUFFER_COUNT
 };
 
+enum
+{
+    FRAMEBUFFER_SCENE = 0,
+    FRAMEBUFFER_COUNT
+};
+
+enum
+{
+    RENDERER_CLIPMAP = 0,  // clipmap layout, LOD by distance
+    RENDERER_TESSELLATION, // patch grid tessellated by projected height error
+    RENDERER_CDLOD,        // quadtree nodes selected by distance, morphing between lods
+    RENDERER_CHUNKED,      // baked chunk meshes selected by screen-space error, clipmap grids nearby
+    RENDERER_COUNT
+};
+
+static const char* const RENDERER_NAMES[RENDERER_COUNT] = { "clipmap", "tessellation", "cdlod", "chunked" };
+
+enum
+{
+    CHUNK_DRAW_MESH = 0, // baked RTIN mesh
+    CHUNK_DRAW_GRID,     // regular grid from a clipmap level
+    CHUNK_DRAW_COUNT
+};
+
+enum
+{
+    RENDER_MODE_INSTANCED = 0, // one instanced draw per layout mesh
+    RENDER_MODE_INDIRECT,      // one multi-draw-indirect for the whole layout
+    RENDER_MODE_OCCLUSION,     // multi-draw-indirect of a compute pass's Hi-Z survivors
+    RENDER_MODE_COUNT
+};
+
+// Index range of a layout mesh in the shared tile buffers
+struct TileMesh {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t  baseVertex;
+};
+
+// Layout fixed by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t  baseVertex;
+    uint32_t baseInstance;
+};
+
+// Frustum culled instance handed to the occlusion pass, std430 layout of hiz_cull.comp
+struct CullCandidate {
+    TileInstance instance;
+    float    lo[3];
+    uint32_t mesh;
+    float    hi[3];
+    uint32_t padding;
+};
+
+static_assert(sizeof(CullCandidate) == 48u);
+
+// Per-instance attributes of a chunk draw, location 1 of chunk.vert
+struct ChunkInstance {
+    float offset[2];   // world xz of the chunk corner
+    float scale;       // world units per grid step, 1 for baked meshes
+    float skirtHeight; // normalized height the grid's skirt drops to
+};
+
+// Camera data of the current frame, std140 layout of the FrameUniforms block every
+// terrain program declares at UNIFORM_BINDING_FRAME
+struct FrameUniforms {
+    glm::mat4 projMatrix;
+    glm::mat4 viewMatrix;
+    glm::vec3 cameraPos;
+    float     projScale; // pixels spanned by a unit size at unit distance
+    glm::vec2 samplerDim;
+    int32_t   finestLevel; // finest clipmap level resident under every renderer's footprint
+    float     padding;
+    glm::vec4 frustumPlanes[6];
+};
+
+static_assert(sizeof(FrameUniforms) == 256u);
+constexpr GLint UNIFORM_BINDING_FRAME = 0;
+
+// Uniforms that change between or within frames, looked up once after linking
+struct UniformHandles {
+    Uniform<GLint>     cullCandidateCount;
+    Uniform<bool>      cullHizValid;
+    Uniform<glm::mat4> cullHizViewProj;
+    Uniform<GLint>     cullHizLevels;
+    Uniform<bool>      reduceFromDepth;
+    Uniform<bool>      chunkClipmapGrid;
+};
+
+// Instances of the last frame and running totals since the last report
+struct CullStats {
+    uint32_t visible = 0u;
+    uint32_t culled = 0u;
+    uint64_t visibleTotal = 0u;
+    uint64_t culledTotal = 0u;
+    uint64_t frames = 0u;
+    double   cullMs = 0.0;
+};
+
 struct OpenGLManager {
-    GLuint programs[PROGRAM_COUNT];
-    GLuint textures[TEXTURE_COUNT];
-    GLuint vertexArrays[VERTEXARRAY_COUNT];
-    GLuint buffers[BUFFER_COUNT];
+    ShaderProgram programs[PROGRAM_COUNT];
+    UniformHandles uniforms;
+    Texture textures[TEXTURE_COUNT];
+    VertexArray vertexArrays[VERTEXARRAY_COUNT];
+    Buffer buffers[BUFFER_COUNT];
+    Framebuffer framebuffers[FRAMEBUFFER_COUNT];
+    GLState state; // every binding and render state change of the frame loop goes through it
 } g_gl;
 
+// Corner of the tessellation patch grid
+struct PatchVertex {
+    float position[2];    // world xz
+    float heightRange[2]; // world height range of the patches sharing the corner
+};
+
 struct AppManager {
-    size_t tileIndexCount = 0;
+    uint32_t renderer = RENDERER_CLIPMAP;
+    uint32_t renderMode = RENDER_MODE_INSTANCED;
+    TileMesh tileMeshes[MESH_COUNT];
+    std::vector<TileInstance> tileInstances[MESH_COUNT];
+    std::vector<TileInstance> visibleInstances[MESH_COUNT];
+
+    // Frustum culling state, boxes in tileInstances order
+    AabbList tileBounds;
+    std::vector<uint8_t> tileVisibility;
+    CullStats cullStats;
+
+    // Everything streamed to the GPU once per frame, one region per frame in flight
+    FrameRing frameRing;
+
+    // The scene renders offscreen so its depth can be reduced into the Hi-Z pyramid
+    int32_t framebufferWidth = 0;
+    int32_t framebufferHeight = 0;
+    int32_t hizLevels = 0;
+    bool hizValid = false;  // the pyramid holds a frame rendered with hizViewProj
+    glm::mat4 hizViewProj;
+    std::vector<CullCandidate> cullCandidates;
+    size_t cullCommandsOffset = 0u; // the culling pass's indirect commands in the frame ring
+
+    // Patch grid of the tessellation renderer, rebuilt as the camera crosses a
+    // patch or the height bounds tighten
+    std::vector<PatchVertex> patchVertices;
+    glm::vec2 patchOrigin { 0.0f, 0.0f };
+    bool patchGridDirty = true;
+
+    // Quadtree of the CDLOD renderer and its last selection, quarters use their
+    // own index range of the tile lattice
+    CdlodTree cdlodTree;
+    CdlodSelection cdlodSelection;
+    TileMesh cdlodQuarterMesh;
+    double cdlodSelectMs = 0.0;
+
+    // Baked chunk meshes, their static bounds and the last frame's draws per
+    // representation; a grid level's index range covers its quads plus skirts
+    TerrainChunks chunks;
+    AabbList chunkBounds;
+    std::vector<uint8_t> chunkVisibility;
+    TileMesh chunkGridMeshes[CLIPMAP_LEVELS];
+    std::vector<ChunkInstance> chunkInstances;
+    std::vector<DrawElementsIndirectCommand> chunkCommands[CHUNK_DRAW_COUNT];
+    double chunkSelectMs = 0.0;
+
     glm::vec2 heightMapDim { 0.0f, 0.0f };
+
+    TerrainPyramid pyramid;
+    TileCache tileCache;
+    MinMaxTree heightBounds;
+    Clipmap clipmap;
 } g_app;
 
 struct CameraManager {
@@ -123,6 +371,20 @@ void cursorPosCallback(GLFWwindow* window, double x, double y)
     y0 = y;
 }
 
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (action != GLFW_PRESS)
+        return;
+
+    if (key == GLFW_KEY_M)
+    {
+        static const char* names[RENDER_MODE_COUNT] = { "instanced", "indirect", "occlusion" };
+        g_app.renderMode = (g_app.renderMode + 1u) % RENDER_MODE_COUNT;
+        g_app.hizValid = false;
+        LOG("Render mode: %s\n", names[g_app.renderMode]);
+    }
+}
+
 void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
     // ImGuiIO& io = ImGui::GetIO();
@@ -137,109 +399,251 @@ void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 }
 
 
-void loadDisplacementMap(std::string pathToFile)
+/**
+ * @brief One-time fallback for a fresh checkout: bakes the demo PNG into the
+ * pyramid format so the next launch only has to map it. Large datasets should
+ * be baked offline with `baker` instead.
+ */
+void bakeHeightmapPyramid(const std::string& imagePath, const std::string& pyramidPath)
 {
-    stbi_set_flip_vertically_on_load(true); 
-    int tex_width, tex_height, tex_num_chan;
-    const uint16_t* tex_data = (const uint16_t*)stbi_load(pathToFile.c_str(), &tex_width, &tex_height, &tex_num_chan, 0);
-
-    if (!tex_data)
-        EXIT("Failed to load texture " + pathToFile);
+    HeightmapFile source;
+    source.open(imagePath);
 
-    std::vector<uint16_t> dmap(tex_width * tex_height *2);
+    BakeSettings settings;
+    settings.levelCount = CLIPMAP_LEVELS;
+    bakePyramid(source.image(), pyramidPath, settings);
+}
 
-    for (int y = 0; y < tex_height; ++y)
+/**
+ * @brief Maps the baked heightmap pyramid and allocates the clipmap levels on
+ * top of it. Nothing but headers is read here, the clipmap pages in tiles as
+ * its windows first touch them.
+ */
+void loadHeightmapPyramid(const std::string& pathToFile)
+{
+    if (!g_app.pyramid.open(pathToFile))
     {
-        for (int x = 0; x < tex_width; ++x)
-        {
-            const int idx = y * tex_width + x;
-            dmap[idx] = tex_data[idx];
-        }
-    }
-
-    glGenTextures(1, &g_gl.textures[TEXTURE_HEIGHTMAP]);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, g_gl.textures[TEXTURE_HEIGHTMAP]);
-    glTexStorage2D(GL_TEXTURE_2D, glm::log2((float)std::max(tex_width, tex_height)), GL_RED, tex_width, tex_height);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex_width, tex_height, GL_RED, GL_UNSIGNED_SHORT, &dmap[0]);
+        LOG("No baked pyramid found (see `baker`), baking ../assets/test3.png into %s\n", pathToFile.c_str());
+        bakeHeightmapPyramid("../assets/test3.png", pathToFile);
 
-    glTexParameteri(GL_TEXTURE_2D,
-                    GL_TEXTURE_MIN_FILTER,
-                    GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D,
-                    GL_TEXTURE_MAG_FILTER,
-                    GL_LINEAR);
-
-    glTexParameteri(GL_TEXTURE_2D,
-                    GL_TEXTURE_WRAP_S,
-                    GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D,
-                    GL_TEXTURE_WRAP_T,
-                    GL_CLAMP_TO_EDGE);
-
-    glGenerateMipmap(GL_TEXTURE_2D);
+        if (!g_app.pyramid.open(pathToFile))
+            EXIT("Failed to open " + pathToFile);
+    }
 
-   stbi_image_free((void*)tex_data);
+    const PyramidLevel& level0 = g_app.pyramid.level(0u);
+    g_app.heightMapDim.x = level0.width;
+    g_app.heightMapDim.y = level0.height;
+
+    // Seed the height bounds from the tile index, streamed level 0 tiles refine them
+    const auto boundsStart = std::chrono::steady_clock::now();
+    g_app.heightBounds.seed(g_app.pyramid);
+    const auto boundsTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - boundsStart);
+    LOG("Seeded height bounds (%u levels) in %.2f ms\n", g_app.heightBounds.getLevelCount(), boundsTime.count());
+
+    g_app.cdlodTree.create({ TILE_DIM, CLIPMAP_LEVELS, CDLOD_RANGE0, CDLOD_MORPH_FRACTION, HEIGHT_SCALE },
+                           level0.width, level0.height);
+
+    g_gl.textures[TEXTURE_CLIPMAP].create(GL_TEXTURE_2D_ARRAY);
+    g_gl.textures[TEXTURE_CLIPMAP_NORMALS].create(GL_TEXTURE_2D_ARRAY);
+    g_gl.buffers[BUFFER_CLIPMAP_UPLOAD].create();
+    g_app.tileCache.create(g_app.pyramid, TILE_CACHE_BUDGET);
+    g_app.tileCache.setDecodeCallback([](uint32_t level, uint32_t tx, uint32_t ty, const uint8_t* data) {
+        if (level == 0u)
+            g_app.heightBounds.reduceTile(tx, ty, data);
+    });
+    g_app.clipmap.create(g_gl.textures[TEXTURE_CLIPMAP].getHandle(), g_gl.textures[TEXTURE_CLIPMAP_NORMALS].getHandle(),
+                         g_gl.buffers[BUFFER_CLIPMAP_UPLOAD].getHandle(), g_app.pyramid, g_app.tileCache,
+                         CLIPMAP_LEVELS, CLIPMAP_DIM, CLIPMAP_UPLOAD_BUDGET, HEIGHT_SCALE);
+
+    LOG("Mapped pyramid %s (%ux%u, %u levels)\n", pathToFile.c_str(),
+        level0.width, level0.height, g_app.pyramid.levelCount());
 }
 
-GLuint create_texture_2d(const std::string tex_filepath)
+/**
+ * @brief Maps the baked chunk meshes, baking them from the demo PNG on a fresh
+ * checkout, and uploads them whole along with one skirted grid per clipmap level.
+ * Large datasets should be meshed offline with `chunkbaker` instead.
+ */
+void loadTerrainChunks(const std::string& pathToFile)
 {
-   GLuint tex_handle;
-   glGenTextures(1, &tex_handle);
-   glBindTexture(GL_TEXTURE_2D, tex_handle);
+    if (!g_app.chunks.open(pathToFile))
+    {
+        LOG("No baked chunks found (see `chunkbaker`), meshing ../assets/test3.png into %s\n", pathToFile.c_str());
+        HeightmapFile source;
+        source.open("../assets/test3.png");
+        bakeChunks(source.image(), pathToFile, ChunkBakeSettings());
 
-   // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-   // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (!g_app.chunks.open(pathToFile))
+            EXIT("Failed to open " + pathToFile);
+    }
 
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    const ChunkHeader& header = g_app.chunks.header();
+    if (header.width != static_cast<uint32_t>(g_app.heightMapDim.x) || header.height != static_cast<uint32_t>(g_app.heightMapDim.y))
+        EXIT(pathToFile + " was baked from a different heightmap than the pyramid");
+    if (header.gridLevels < CLIPMAP_LEVELS)
+        EXIT(pathToFile + " has chunks smaller than a texel of the coarsest clipmap level");
 
-   stbi_set_flip_vertically_on_load(true); 
-   int tex_width, tex_height, tex_num_chan;
-   unsigned char* tex_data = stbi_load(tex_filepath.c_str(), &tex_width, &tex_height, &tex_num_chan, 4);
+    // Bounds never change, the boxes are culled as they are every frame
+    for (uint32_t chunk = 0u; chunk < g_app.chunks.chunkCount(); ++chunk)
+    {
+        const ChunkEntry& entry = g_app.chunks.entry(chunk);
+        const glm::vec2 corner = glm::vec2(chunk % header.chunksX, chunk / header.chunksX) * float(header.chunkSize);
+        g_app.chunkBounds.push({ corner.x, entry.minHeight * HEIGHT_SCALE, corner.y },
+                               { corner.x + header.chunkSize, entry.maxHeight * HEIGHT_SCALE, corner.y + header.chunkSize });
+    }
+    g_app.chunkVisibility.resize(g_app.chunks.chunkCount());
 
-   if (!tex_data)
-      EXIT("Failed to load texture " + tex_filepath);
+    // Grid level L spans chunkSize >> L quads plus a skirt quad on every side
+    const uint32_t gridWidth = header.chunkSize + 3u;
+    std::vector<uint32_t> gridIndices;
+    for (uint32_t level = 0u; level < CLIPMAP_LEVELS; ++level)
+    {
+        const uint32_t quads = (header.chunkSize >> level) + 2u;
+        std::vector<uint32_t> indices;
+        if (TILE_STRIPS)
+        {
+            indices = buildGridStrips(quads, quads, gridWidth, gridStripBlockWidth(VERTEX_CACHE_SIZE));
+        }
+        else
+        {
+            indices = buildGridTriangles(quads, quads, gridWidth);
+            optimizeVertexCache(indices, gridWidth * (quads + 1u), VERTEX_CACHE_SIZE);
+        }
+        g_app.chunkGridMeshes[level] = { static_cast<uint32_t>(gridIndices.size()), static_cast<uint32_t>(indices.size()), 0 };
+        gridIndices.insert(gridIndices.end(), indices.begin(), indices.end());
+    }
 
-   uint64_t format = 0x0;
-   switch (tex_num_chan)
-   {
-      case 1:
-         format = GL_RGBA;
-         break;
-      case 3:
-         format = GL_RGB;
-         break;
-      case 4:
-         format = GL_RGBA;
-         break;
-      default:
-         EXIT("Failed to load texture " + tex_filepath);
-   }
+    Buffer& vertexBuffer = g_gl.buffers[BUFFER_VERTEX_CHUNK];
+    Buffer& indexBuffer = g_gl.buffers[BUFFER_INDEX_CHUNK];
+    Buffer& gridIndexBuffer = g_gl.buffers[BUFFER_INDEX_CHUNK_GRID];
+    vertexBuffer.create();
+    indexBuffer.create();
+    gridIndexBuffer.create();
+    vertexBuffer.storage(sizeof(ChunkVertex) * header.vertexCount, g_app.chunks.vertices());
+    indexBuffer.storage(sizeof(uint32_t) * header.indexCount, g_app.chunks.indices());
+    gridIndexBuffer.storage(sizeof(uint32_t) * gridIndices.size(), gridIndices.data());
+
+    // Vertices on binding 0, instances streamed through the frame ring on binding 1
+    auto setupChunkInstances = [](const VertexArray& vertexArray) {
+        vertexArray.attribute(1u, 1u, 4, GL_FLOAT, offsetof(ChunkInstance, offset));
+        vertexArray.vertexBuffer(1u, g_gl.buffers[BUFFER_FRAME_RING], 0u, sizeof(ChunkInstance), 1u);
+    };
 
-   glTexImage2D(GL_TEXTURE_2D, 0, format, tex_width, tex_height, 0, format, GL_UNSIGNED_BYTE, tex_data);
-//    glGenerateMipmap(GL_TEXTURE_2D);
+    VertexArray& chunkArray = g_gl.vertexArrays[VERTEXARRAY_CHUNK];
+    chunkArray.create();
+    setupChunkInstances(chunkArray);
+    chunkArray.attribute(0u, 0u, 2, GL_UNSIGNED_SHORT, offsetof(ChunkVertex, position));
+    chunkArray.attribute(2u, 0u, 1, GL_FLOAT, offsetof(ChunkVertex, height));
+    chunkArray.attribute(3u, 0u, 2, GL_FLOAT, offsetof(ChunkVertex, gradient));
+    chunkArray.vertexBuffer(0u, vertexBuffer, 0u, sizeof(ChunkVertex));
+    chunkArray.elementBuffer(indexBuffer);
+
+    VertexArray& gridArray = g_gl.vertexArrays[VERTEXARRAY_CHUNK_GRID];
+    gridArray.create();
+    setupChunkInstances(gridArray);
+    gridArray.elementBuffer(gridIndexBuffer);
+
+    LOG("Mapped chunks %s (%ux%u of %u quads, %u lods, %.1f MiB of meshes)\n", pathToFile.c_str(), header.chunksX,
+        header.chunksY, header.chunkSize, header.lodCount,
+        (sizeof(ChunkVertex) * header.vertexCount + sizeof(uint32_t) * header.indexCount) / 1048576.0);
+}
+
+/**
+ * @brief Sets every uniform that stays fixed for the run once and caches the
+ * handles of those that do not.
+ */
+void setupProgramUniforms()
+{
+    for (const ShaderProgram& program : g_gl.programs)
+        program.checkUniformBlock("FrameUniforms", UNIFORM_BINDING_FRAME, sizeof(FrameUniforms));
 
-   g_app.heightMapDim.x = tex_width;
-   g_app.heightMapDim.y = tex_height;
-   stbi_image_free(tex_data);
+    // Terrain programs sample the clipmap from units 0 and 1
+    for (uint32_t p : { PROGRAM_DEFAULT, PROGRAM_TESSELLATION, PROGRAM_CDLOD, PROGRAM_CHUNK })
+    {
+        const ShaderProgram& program = g_gl.programs[p];
+        program.set<GLint>("u_clipmap", 0);
+        program.set<GLint>("u_clipmapNormals", 1);
+        program.set<GLint>("u_clipmapDim", CLIPMAP_DIM);
+        program.set<float>("u_heightScale", HEIGHT_SCALE);
+    }
 
-   return tex_handle;
+    const ShaderProgram& clipmap = g_gl.programs[PROGRAM_DEFAULT];
+    clipmap.set<GLint>("u_tileDim", TILE_DIM);
+    clipmap.set<GLint>("u_latticeWidth", TILE_LATTICE_WIDTH);
+    clipmap.set<GLint>("u_levelCount", CLIPMAP_LEVELS);
+    clipmap.set<bool>("u_vertexFromId", TILE_VERTEX_FORMAT == TILE_VERTEX_ID);
+
+    const ShaderProgram& tessellation = g_gl.programs[PROGRAM_TESSELLATION];
+    tessellation.set<float>("u_errorPixels", TESSELLATION_ERROR_PIXELS);
+    tessellation.set<GLint>("u_tileDim", TILE_DIM);
+    tessellation.set<GLint>("u_levelCount", CLIPMAP_LEVELS);
+
+    const ShaderProgram& cdlod = g_gl.programs[PROGRAM_CDLOD];
+    cdlod.set<GLint>("u_latticeWidth", TILE_LATTICE_WIDTH);
+    cdlod.set<GLint>("u_levelCount", CLIPMAP_LEVELS);
+    cdlod.set<bool>("u_vertexFromId", TILE_VERTEX_FORMAT == TILE_VERTEX_ID);
+    cdlod.set<float>("u_morphStart", g_app.cdlodTree.getMorphStarts(), CLIPMAP_LEVELS);
+    cdlod.set<float>("u_morphEnd", g_app.cdlodTree.getMorphEnds(), CLIPMAP_LEVELS);
+
+    const ShaderProgram& chunk = g_gl.programs[PROGRAM_CHUNK];
+    chunk.set<GLint>("u_chunkSize", g_app.chunks.header().chunkSize);
+    chunk.set<GLint>("u_gridWidth", g_app.chunks.header().chunkSize + 3u);
+    g_gl.uniforms.chunkClipmapGrid = chunk.uniform<bool>("u_clipmapGrid");
+
+    const ShaderProgram& reduce = g_gl.programs[PROGRAM_HIZ_REDUCE];
+    reduce.set<GLint>("u_depth", 0);
+    g_gl.uniforms.reduceFromDepth = reduce.uniform<bool>("u_fromDepth");
+
+    const ShaderProgram& cull = g_gl.programs[PROGRAM_HIZ_CULL];
+    cull.set<GLint>("u_hiz", 0);
+    g_gl.uniforms.cullCandidateCount = cull.uniform<GLint>("u_candidateCount");
+    g_gl.uniforms.cullHizValid = cull.uniform<bool>("u_hizValid");
+    g_gl.uniforms.cullHizViewProj = cull.uniform<glm::mat4>("u_hizViewProj");
+    g_gl.uniforms.cullHizLevels = cull.uniform<GLint>("u_hizLevels");
 }
 
+/**
+ * @brief Sizes the frame regions for the largest frame any renderer streams:
+ * the frame uniforms plus the visible layout, the occlusion candidates, a full
+ * CDLOD selection or every chunk, with room for each allocation's alignment.
+ */
+void createFrameRing()
+{
+    const size_t tileBytes = std::max(sizeof(TileInstance) * TILE_INSTANCE_COUNT + sizeof(DrawElementsIndirectCommand) * MESH_COUNT,
+                                      sizeof(CullCandidate) * TILE_INSTANCE_COUNT);
+    const size_t cdlodBytes = sizeof(TileInstance) * g_app.cdlodTree.getMaxSelectionSize();
+    const size_t chunkBytes = (sizeof(ChunkInstance) + sizeof(DrawElementsIndirectCommand)) * g_app.chunks.chunkCount();
+
+    // GL caps binding offset alignments at 256 bytes, a frame makes at most four allocations
+    const size_t regionSize = (sizeof(FrameUniforms) + std::max({ tileBytes, cdlodBytes, chunkBytes }) + 4u * 256u + 255u) & ~size_t(255u);
+    g_app.frameRing.create(g_gl.buffers[BUFFER_FRAME_RING].getHandle(), regionSize, FRAME_REGIONS);
+}
 
 void init()
 {
+    // Created before the VAOs sourcing instances from it, storage follows once the data is loaded
+    g_gl.buffers[BUFFER_FRAME_RING].create();
+
     g_gl.programs[PROGRAM_DEFAULT] = createProgram("../shaders/default.vert", "../shaders/default.frag", "default");
+    g_gl.programs[PROGRAM_HIZ_REDUCE] = createComputeProgram("../shaders/hiz_reduce.comp", "hiz reduce");
+    g_gl.programs[PROGRAM_HIZ_CULL] = createComputeProgram("../shaders/hiz_cull.comp", "hiz cull");
+    g_gl.programs[PROGRAM_TESSELLATION] = createProgram("../shaders/terrain_tess.vert", "../shaders/terrain_tess.tesc",
+                                                        "../shaders/terrain_tess.tese", "../shaders/default.frag",
+                                                        "tessellation");
+    g_gl.programs[PROGRAM_CDLOD] = createProgram("../shaders/cdlod.vert", "../shaders/default.frag", "cdlod");
+    g_gl.programs[PROGRAM_CHUNK] = createProgram("../shaders/chunk.vert", "../shaders/default.frag", "chunk");
+
+    const ProgramCache::Stats& programCache = getProgramCacheStats();
+    LOG("Program cache: %u hits, %u misses (%u rejected by the driver)\n", programCache.hits, programCache.misses,
+        programCache.rejected);
 
     g_camera.camera.setPerspectiveProjection(glm::radians(50.f), VIEWER_WIDTH /  VIEWER_HEIGHT, 0.1f, 10000.f);
     updateCameraMatrix();
 
-    g_gl.textures[TEXTURE_HEIGHTMAP] =  create_texture_2d("../assets/test3.png");
-    // g_gl.textures[TEXTURE_HEIGHTMAP] =  create_texture_2d("../assets/wall.jpg");
-    // loadDisplacementMap("../assets/test1.png");
+    loadHeightmapPyramid("../assets/terrain.tpyr");
+    loadTerrainChunks("../assets/terrain.tchk");
+    createFrameRing();
+    setupProgramUniforms();
 
     // Test Triangle
     {
@@ -249,199 +653,901 @@ void init()
             0.0f,  0.5f, 0.0f
         }; 
 
-        glGenVertexArrays(1, &g_gl.vertexArrays[VERTEXARRAY_TEST_TRIANGLE]);
-        glBindVertexArray(g_gl.vertexArrays[VERTEXARRAY_TEST_TRIANGLE]);
-
-        glGenBuffers(1, &g_gl.buffers[BUFFER_TEST_TRIANGLE]);
-        glBindBuffer(GL_ARRAY_BUFFER, g_gl.buffers[BUFFER_TEST_TRIANGLE]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), (void*)vertices, GL_STATIC_DRAW);
+        g_gl.buffers[BUFFER_TEST_TRIANGLE].create();
+        g_gl.buffers[BUFFER_TEST_TRIANGLE].storage(sizeof(vertices), vertices);
 
-        glEnableVertexAttribArray(0u);
-        glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3,
-                    (void*)(0));
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0u);
-        glBindVertexArray(0u);
+        VertexArray& vertexArray = g_gl.vertexArrays[VERTEXARRAY_TEST_TRIANGLE];
+        vertexArray.create();
+        vertexArray.attribute(0u, 0u, 3, GL_FLOAT, 0u);
+        vertexArray.vertexBuffer(0u, g_gl.buffers[BUFFER_TEST_TRIANGLE], 0u, sizeof(float) * 3);
     }
 
     {
-        // (0,0) is the bottom left of the plane
-
+        // One lattice of integer grid points shared by every layout mesh
         struct Vertex {
-            float pos[3];
-
-            Vertex(float x, float y, float z)
-                : pos {x, y, z}
-            {}
+            uint16_t pos[2];
         };
 
         std::vector<Vertex> vertices;
+        if (TILE_VERTEX_FORMAT == TILE_VERTEX_GRID16)
+        {
+            for (uint16_t y = 0u; y < layoutLatticeHeight(TILE_DIM); ++y)
+                for (uint16_t x = 0u; x < TILE_LATTICE_WIDTH; ++x)
+                    vertices.push_back({ { x, y } });
+        }
 
-        const float step = 1.0f / TILE_DIM;
-
-        for (size_t y = 0; y < (TILE_DIM + 1u); ++y)
+        // Every mesh ordered for the post-transform cache, as every vertex costs
+        // up to ten texture fetches; narrowing maps the 32-bit restart index onto
+        // the 16-bit one
+        std::vector<TileIndex> tileIndices;
+        for (uint32_t mesh = 0u; mesh < MESH_COUNT; ++mesh)
         {
-            const float y_val = y * step;
-            for (size_t x = 0; x < (TILE_DIM + 1u); ++x)
+            const std::vector<uint32_t> indices = buildLayoutMesh(mesh, TILE_DIM, TILE_STRIPS, VERTEX_CACHE_SIZE);
+            g_app.tileMeshes[mesh] = { static_cast<uint32_t>(tileIndices.size()), static_cast<uint32_t>(indices.size()), 0 };
+            tileIndices.insert(tileIndices.end(), indices.begin(), indices.end());
+
+            if (mesh == MESH_TILE)
             {
-                const float x_val = x * step;
-                vertices.emplace_back(x_val, 0.0f, y_val);
+                LOG("Tile mesh: %zu indices, ACMR %.3f at a %u entry cache\n", indices.size(),
+                    simulateVertexCache(indices, TILE_STRIPS, VERTEX_CACHE_SIZE).acmr(), VERTEX_CACHE_SIZE);
             }
         }
 
-        // constexpr size_t numIndiciesPerRow = 2u * (TILE_DIM + 1u);
-        // constexpr size_t numIndices = 2u * (TILE_DIM * TILE_DIM + 2 * TILE_DIM - 1);
-        // std::vector<uint32_t> indices(numIndices);
-
-        // for (uint32_t y = 0u; y < TILE_DIM; ++y)
-        // {
-        //     const size_t rowStartIndex = y * numIndiciesPerRow + y * 2u;
-        //     const size_t rowEndIndex   = rowStartIndex + numIndiciesPerRow; 
-
-        //     for (uint32_t i = rowStartIndex, j = 0u; i < rowEndIndex; i+=2u, ++j)
-        //     {
-        //         indices[i] = (TILE_DIM + 1u) * y + j;
-        //     }
-
-        //     for (uint32_t i = rowStartIndex + 1u; i < rowEndIndex; i+=2u)
-        //     {
-        //         indices[i] = indices[i-1u] + TILE_DIM + 1u;
-        //     }
-
-        //     // Degenerate Triangles
-        //     if (y != TILE_DIM - 1u)
-        //     {
-        //         indices[rowEndIndex] = indices[rowEndIndex-1];
-        //         indices[rowEndIndex+1] = indices[rowStartIndex+1];
-        //     }
-        // }    
-
-        constexpr size_t numIndices = 6u * TILE_DIM * TILE_DIM;
-        std::vector<uint32_t> indices(numIndices);
-
-        size_t idx = 0;
-        for (uint32_t y = 0u; y < TILE_DIM; ++y)
+        // A CDLOD quarter is the low corner of the tile at twice the spacing
         {
-            const uint32_t start = y * TILE_DIM + y;
-            const uint32_t end   = start + TILE_DIM + 1u;
-            for (uint32_t x = 0u; x < TILE_DIM; ++x)
+            std::vector<uint32_t> indices;
+            if (TILE_STRIPS)
             {
-                indices[idx++] = start + x;
-                indices[idx++] = end + x;
-                indices[idx++] = start + 1u + x;
+                indices = buildGridStrips(TILE_DIM / 2u, TILE_DIM / 2u, TILE_LATTICE_WIDTH,
+                                          gridStripBlockWidth(VERTEX_CACHE_SIZE));
+            }
+            else
+            {
+                indices = buildGridTriangles(TILE_DIM / 2u, TILE_DIM / 2u, TILE_LATTICE_WIDTH);
+                optimizeVertexCache(indices, TILE_VERTEX_COUNT, VERTEX_CACHE_SIZE);
+            }
+            g_app.cdlodQuarterMesh = { static_cast<uint32_t>(tileIndices.size()), static_cast<uint32_t>(indices.size()), 0 };
+            tileIndices.insert(tileIndices.end(), indices.begin(), indices.end());
+        }
+
+        LOG("Clipmap layout: %u meshes, %zu vertex + %zu index bytes\n", MESH_COUNT,
+            sizeof(Vertex) * vertices.size(), sizeof(TileIndex) * tileIndices.size());
+
+        g_gl.buffers[BUFFER_VERTEX_TILE].create();
+        g_gl.buffers[BUFFER_INDEX_TILE].create();
+        g_gl.buffers[BUFFER_INSTANCE_TILE].create();
+
+        if (!vertices.empty())
+            g_gl.buffers[BUFFER_VERTEX_TILE].storage(sizeof(Vertex) * vertices.size(), vertices.data());
+        g_gl.buffers[BUFFER_INDEX_TILE].storage(sizeof(TileIndex) * tileIndices.size(), tileIndices.data());
+
+        // Tile placement, refilled every frame by render()
+        g_gl.buffers[BUFFER_INSTANCE_TILE].data(sizeof(TileInstance) * TILE_INSTANCE_COUNT, nullptr, GL_STREAM_DRAW);
 
-                indices[idx++] = end + x;
-                indices[idx++] = end + 1u + x;
-                indices[idx++] = start + 1u + x;
+        // Every tile VAO shares the lattice and indices and differs only in
+        // where instances come from: lattice on binding 0, instances on binding 1
+        auto setupTileVertexArray = [&](VertexArray& vertexArray, const Buffer& instanceBuffer) {
+            vertexArray.create();
+            vertexArray.elementBuffer(g_gl.buffers[BUFFER_INDEX_TILE]);
 
-                // LOG("%d %d %d \t %d %d %d\n", start + x, end + x, start + 1u + x, end + x, end + 1u + x, start + 1u + x);
+            if (!vertices.empty())
+            {
+                vertexArray.attribute(0u, 0u, 2, GL_UNSIGNED_SHORT, offsetof(Vertex, pos));
+                vertexArray.vertexBuffer(0u, g_gl.buffers[BUFFER_VERTEX_TILE], 0u, sizeof(Vertex));
             }
+
+            vertexArray.attribute(1u, 1u, 3, GL_FLOAT, offsetof(TileInstance, offset));
+            vertexArray.integerAttribute(2u, 1u, 2, GL_UNSIGNED_SHORT, offsetof(TileInstance, level));
+            vertexArray.vertexBuffer(1u, instanceBuffer, 0u, sizeof(TileInstance), 1u);
+        };
+
+        setupTileVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE], g_gl.buffers[BUFFER_INSTANCE_TILE]);
+        // Instances sourced from the frame ring at each command's baseInstance
+        setupTileVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE_INDIRECT], g_gl.buffers[BUFFER_FRAME_RING]);
+
+        // Occlusion candidates and commands stream through the frame ring,
+        // survivors never leave the GPU
+        g_gl.buffers[BUFFER_CULL_SURVIVORS].create();
+        g_gl.buffers[BUFFER_CULL_SURVIVORS].storage(sizeof(TileInstance) * TILE_INSTANCE_COUNT, nullptr);
+        g_app.cullCandidates.reserve(TILE_INSTANCE_COUNT);
+
+        setupTileVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE_OCCLUSION], g_gl.buffers[BUFFER_CULL_SURVIVORS]);
+
+        // CDLOD selections stream through the frame ring like the indirect layout
+        setupTileVertexArray(g_gl.vertexArrays[VERTEXARRAY_CDLOD], g_gl.buffers[BUFFER_FRAME_RING]);
+    }
+
+    // Tessellation patch grid, corners refilled by updatePatchGrid()
+    {
+        std::vector<uint16_t> indices;
+        indices.reserve(4u * PATCH_RESOLUTION * PATCH_RESOLUTION);
+        for (uint32_t y = 0u; y < PATCH_RESOLUTION; ++y)
+        {
+            for (uint32_t x = 0u; x < PATCH_RESOLUTION; ++x)
+            {
+                const uint16_t corner = static_cast<uint16_t>(y * (PATCH_RESOLUTION + 1u) + x);
+                indices.insert(indices.end(), { corner, static_cast<uint16_t>(corner + 1u),
+                                                static_cast<uint16_t>(corner + PATCH_RESOLUTION + 2u),
+                                                static_cast<uint16_t>(corner + PATCH_RESOLUTION + 1u) });
+            }
+        }
+
+        Buffer& vertexBuffer = g_gl.buffers[BUFFER_VERTEX_PATCH];
+        Buffer& indexBuffer = g_gl.buffers[BUFFER_INDEX_PATCH];
+        vertexBuffer.create();
+        indexBuffer.create();
+        vertexBuffer.storage(sizeof(PatchVertex) * PATCH_VERTEX_COUNT, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        indexBuffer.storage(sizeof(uint16_t) * indices.size(), indices.data());
+
+        VertexArray& vertexArray = g_gl.vertexArrays[VERTEXARRAY_PATCH];
+        vertexArray.create();
+        vertexArray.attribute(0u, 0u, 2, GL_FLOAT, offsetof(PatchVertex, position));
+        vertexArray.attribute(1u, 0u, 2, GL_FLOAT, offsetof(PatchVertex, heightRange));
+        vertexArray.vertexBuffer(0u, vertexBuffer, 0u, sizeof(PatchVertex));
+        vertexArray.elementBuffer(indexBuffer);
+
+        g_app.patchVertices.resize(PATCH_VERTEX_COUNT);
+    }
+
+    // Offscreen scene, presented by a blit, and the depth pyramid reduced from it
+    {
+        glfwGetFramebufferSize(glfwGetCurrentContext(), &g_app.framebufferWidth, &g_app.framebufferHeight);
+        const int32_t width = g_app.framebufferWidth;
+        const int32_t height = g_app.framebufferHeight;
+
+        Texture& color = g_gl.textures[TEXTURE_SCENE_COLOR];
+        Texture& depth = g_gl.textures[TEXTURE_SCENE_DEPTH];
+        Texture& hiz = g_gl.textures[TEXTURE_HIZ];
+        color.create(GL_TEXTURE_2D);
+        depth.create(GL_TEXTURE_2D);
+        hiz.create(GL_TEXTURE_2D);
+        allocateTextureStorage(color.getHandle(), GL_TEXTURE_2D, GL_RGBA8, width, height, 1, 1, "scene color");
+        allocateTextureStorage(depth.getHandle(), GL_TEXTURE_2D, GL_DEPTH_COMPONENT32F, width, height, 1, 1,
+                               "scene depth");
+        depth.parameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        depth.parameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        g_app.hizLevels = 1;
+        while ((std::max(width, height) >> g_app.hizLevels) > 0)
+            ++g_app.hizLevels;
+        allocateTextureStorage(hiz.getHandle(), GL_TEXTURE_2D, GL_R32F, width, height, 1, g_app.hizLevels, "hiz");
+        hiz.parameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        hiz.parameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        Framebuffer& framebuffer = g_gl.framebuffers[FRAMEBUFFER_SCENE];
+        framebuffer.create();
+        framebuffer.attach(GL_COLOR_ATTACHMENT0, color);
+        framebuffer.attach(GL_DEPTH_ATTACHMENT, depth);
+        if (!framebuffer.isComplete())
+            EXIT("Scene framebuffer is incomplete");
+    }
+}
+
+/**
+ * @brief Frustum culls every layout instance as a box spanning its height range
+ * in the min/max tree, all instances at once, and compacts the survivors into
+ * g_app.visibleInstances.
+ */
+void cullClipmapLayout()
+{
+    const auto start = std::chrono::steady_clock::now();
+    const Frustum frustum = extractFrustum(g_camera.camera.getProjection() * g_camera.view);
+
+    g_app.tileBounds.clear();
+    for (uint32_t m = 0u; m < MESH_COUNT; ++m)
+    {
+        for (const TileInstance& tile : g_app.tileInstances[m])
+        {
+            glm::vec2 lo, hi;
+            layoutInstanceBounds(m, TILE_DIM, tile, lo, hi);
+
+            // Texels average the samples after them, morphing reaches a texel of
+            // the next level past the instance
+            const float pad = 3.0f * tile.scale;
+            const HeightRange range = g_app.heightBounds.query(
+                static_cast<int32_t>(lo.x - pad), static_cast<int32_t>(lo.y - pad),
+                static_cast<int32_t>(hi.x + pad) + 1, static_cast<int32_t>(hi.y + pad) + 1);
+
+            g_app.tileBounds.push({ lo.x, range.min * HEIGHT_SCALE, lo.y }, { hi.x, range.max * HEIGHT_SCALE, hi.y });
+        }
+    }
+
+    g_app.tileVisibility.resize(g_app.tileBounds.size());
+    cullAabbs(frustum, g_app.tileBounds, g_app.tileVisibility.data());
+
+    size_t box = 0u;
+    uint32_t visible = 0u;
+    for (uint32_t m = 0u; m < MESH_COUNT; ++m)
+    {
+        g_app.visibleInstances[m].clear();
+        for (const TileInstance& tile : g_app.tileInstances[m])
+            if (g_app.tileVisibility[box++])
+                g_app.visibleInstances[m].push_back(tile);
+        visible += static_cast<uint32_t>(g_app.visibleInstances[m].size());
+    }
+
+    CullStats& stats = g_app.cullStats;
+    stats.visible = visible;
+    stats.culled = static_cast<uint32_t>(box) - visible;
+    stats.visibleTotal += stats.visible;
+    stats.culledTotal += stats.culled;
+    ++stats.frames;
+    stats.cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Copies the visible layout instances into the frame ring, grouped by
+ * mesh, and submits one command per mesh with one multi-draw.
+ */
+void drawTilesIndirect()
+{
+    size_t visibleCount = 0u;
+    for (const std::vector<TileInstance>& visible : g_app.visibleInstances)
+        visibleCount += visible.size();
+
+    FrameRing& ring = g_app.frameRing;
+    const FrameAllocation instanceData = ring.allocate(sizeof(TileInstance) * visibleCount, sizeof(TileInstance));
+    const FrameAllocation commandData = ring.allocate(sizeof(DrawElementsIndirectCommand) * MESH_COUNT,
+                                                      alignof(DrawElementsIndirectCommand));
+    TileInstance* instances = reinterpret_cast<TileInstance*>(instanceData.data);
+    DrawElementsIndirectCommand* commands = reinterpret_cast<DrawElementsIndirectCommand*>(commandData.data);
+    const uint32_t firstInstance = static_cast<uint32_t>(instanceData.offset / sizeof(TileInstance));
+
+    uint32_t instanceCount = 0u;
+    uint32_t drawCount = 0u;
+    for (uint32_t m = 0u; m < MESH_COUNT; ++m)
+    {
+        const std::vector<TileInstance>& visible = g_app.visibleInstances[m];
+        if (visible.empty())
+            continue;
+
+        std::copy(visible.begin(), visible.end(), instances + instanceCount);
+
+        const TileMesh& mesh = g_app.tileMeshes[m];
+        commands[drawCount++] = { mesh.indexCount, static_cast<uint32_t>(visible.size()), mesh.firstIndex,
+                                  mesh.baseVertex, firstInstance + instanceCount };
+        instanceCount += static_cast<uint32_t>(visible.size());
+    }
+
+    g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE_INDIRECT]);
+    g_gl.state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, ring.getBuffer());
+    glMultiDrawElementsIndirect(TILE_PRIMITIVE, TILE_INDEX_TYPE, reinterpret_cast<const void*>(commandData.offset),
+                                static_cast<GLsizei>(drawCount), 0);
+}
+
+/**
+ * @brief Draws the visible layout with one instanced draw per mesh, each sourcing
+ * its run of the instance buffer.
+ */
+void drawTilesInstanced()
+{
+    const Buffer& instanceBuffer = g_gl.buffers[BUFFER_INSTANCE_TILE];
+    instanceBuffer.data(sizeof(TileInstance) * TILE_INSTANCE_COUNT, nullptr, GL_STREAM_DRAW);
+
+    uint32_t firstInstance[MESH_COUNT];
+    uint32_t instanceCount = 0u;
+    for (uint32_t m = 0u; m < MESH_COUNT; ++m)
+    {
+        const std::vector<TileInstance>& instances = g_app.visibleInstances[m];
+        firstInstance[m] = instanceCount;
+        instanceBuffer.subData(sizeof(TileInstance) * instanceCount, sizeof(TileInstance) * instances.size(),
+                               instances.data());
+        instanceCount += static_cast<uint32_t>(instances.size());
+    }
+
+    g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE]);
+    for (uint32_t m = 0u; m < MESH_COUNT; ++m)
+    {
+        if (g_app.visibleInstances[m].empty())
+            continue;
+
+        const TileMesh& mesh = g_app.tileMeshes[m];
+        glDrawElementsInstancedBaseInstance(TILE_PRIMITIVE, mesh.indexCount, TILE_INDEX_TYPE,
+                                            reinterpret_cast<const void*>(sizeof(TileIndex) * mesh.firstIndex),
+                                            static_cast<GLsizei>(g_app.visibleInstances[m].size()), firstInstance[m]);
+    }
+}
+
+/**
+ * @brief Hands the frustum culled instances and their boxes to the Hi-Z culling
+ * pass, which appends those not hidden in the last frame's depth pyramid to one
+ * indirect command per mesh. Counts start at zero and never come back to the CPU.
+ */
+void dispatchOcclusionCulling()
+{
+    const AabbList& bounds = g_app.tileBounds;
+    const FrameAllocation commandData = g_app.frameRing.allocateStorage(sizeof(DrawElementsIndirectCommand) * MESH_COUNT);
+    DrawElementsIndirectCommand* commands = reinterpret_cast<DrawElementsIndirectCommand*>(commandData.data);
+    g_app.cullCommandsOffset = commandData.offset;
+
+    std::vector<CullCandidate>& candidates = g_app.cullCandidates;
+    candidates.clear();
+
+    size_t box = 0u;
+    for (uint32_t m = 0u; m < MESH_COUNT; ++m)
+    {
+        const TileMesh& mesh = g_app.tileMeshes[m];
+        commands[m] = { mesh.indexCount, 0u, mesh.firstIndex, mesh.baseVertex, static_cast<uint32_t>(candidates.size()) };
+
+        for (const TileInstance& tile : g_app.tileInstances[m])
+        {
+            const size_t b = box++;
+            if (g_app.tileVisibility[b])
+                candidates.push_back({ tile, { bounds.loX[b], bounds.loY[b], bounds.loZ[b] }, m,
+                                       { bounds.hiX[b], bounds.hiY[b], bounds.hiZ[b] }, 0u });
         }
+    }
+
+    // Never an empty range, GL rejects binding one
+    const size_t candidateBytes = sizeof(CullCandidate) * std::max<size_t>(candidates.size(), 1u);
+    const FrameAllocation candidateData = g_app.frameRing.allocateStorage(candidateBytes);
+    std::copy(candidates.begin(), candidates.end(), reinterpret_cast<CullCandidate*>(candidateData.data));
+
+
+    g_gl.state.useProgram(g_gl.programs[PROGRAM_HIZ_CULL]);
+    g_gl.state.bindBufferRange(GL_SHADER_STORAGE_BUFFER, 0u, g_app.frameRing.getBuffer(), candidateData.offset, candidateBytes);
+    g_gl.state.bindBufferRange(GL_SHADER_STORAGE_BUFFER, 1u, g_app.frameRing.getBuffer(), commandData.offset,
+                               sizeof(DrawElementsIndirectCommand) * MESH_COUNT);
+    g_gl.state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, g_gl.buffers[BUFFER_CULL_SURVIVORS]);
+    g_gl.state.bindTexture(0u, g_gl.textures[TEXTURE_HIZ]);
+
+    g_gl.uniforms.cullCandidateCount.set(static_cast<GLint>(candidates.size()));
+    g_gl.uniforms.cullHizValid.set(g_app.hizValid);
+    g_gl.uniforms.cullHizViewProj.set(g_app.hizViewProj);
+    g_gl.uniforms.cullHizLevels.set(g_app.hizLevels);
+
+    if (!candidates.empty())
+        glDispatchCompute(static_cast<GLuint>((candidates.size() + 63u) / 64u), 1u, 1u);
+
+    // Survivors feed vertex attributes, counts the indirect draw
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void drawTilesOcclusionCulled()
+{
+    g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE_OCCLUSION]);
+    g_gl.state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, g_app.frameRing.getBuffer());
+    glMultiDrawElementsIndirect(TILE_PRIMITIVE, TILE_INDEX_TYPE, reinterpret_cast<const void*>(g_app.cullCommandsOffset),
+                                MESH_COUNT, 0);
+}
+
+/**
+ * @brief Reduces the scene depth into the Hi-Z pyramid, every texel holding the
+ * farthest depth below it, for the next frame's occlusion pass.
+ */
+void buildHiZ(const glm::mat4& viewProj)
+{
+    g_gl.state.useProgram(g_gl.programs[PROGRAM_HIZ_REDUCE]);
+    g_gl.state.bindTexture(0u, g_gl.textures[TEXTURE_SCENE_DEPTH]);
 
-        glGenVertexArrays(1, &g_gl.vertexArrays[VERTEXARRAY_TILE]);
-        glGenBuffers(1, &g_gl.buffers[BUFFER_VERTEX_TILE]);
-        glGenBuffers(1, &g_gl.buffers[BUFFER_INDEX_TILE]);
+    for (int32_t level = 0; level < g_app.hizLevels; ++level)
+    {
+        const GLuint width = std::max(g_app.framebufferWidth >> level, 1);
+        const GLuint height = std::max(g_app.framebufferHeight >> level, 1);
 
-        glBindVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE]);
-    
-        glBindBuffer(GL_ARRAY_BUFFER, g_gl.buffers[BUFFER_VERTEX_TILE]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+        g_gl.uniforms.reduceFromDepth.set(level == 0);
+        if (level > 0)
+            glBindImageTexture(0u, g_gl.textures[TEXTURE_HIZ].getHandle(), level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1u, g_gl.textures[TEXTURE_HIZ].getHandle(), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        glDispatchCompute((width + 7u) / 8u, (height + 7u) / 8u, 1u);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_gl.buffers[BUFFER_INDEX_TILE]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    // The scene depth stays attached to the framebuffer drawn next frame
+    g_gl.state.bindTexture(0u, 0u);
 
-        glEnableVertexAttribArray(0u);
-        glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, pos));
+    g_app.hizViewProj = viewProj;
+    g_app.hizValid = true;
+}
 
-        glBindVertexArray(0u);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-        glBindBuffer(GL_ARRAY_BUFFER, 0u);
+/**
+ * @brief Centers the patch grid on the camera, snapped to whole patches, and
+ * bounds every corner by the height range of the patches around it. Skipped
+ * while neither the snapped origin nor the height bounds changed.
+ */
+void updatePatchGrid()
+{
+    constexpr uint32_t corners = PATCH_RESOLUTION + 1u;
+    const glm::vec2 camera { g_camera.pos.x, g_camera.pos.z };
+    const glm::vec2 origin = glm::floor(camera / PATCH_SIZE) * PATCH_SIZE - 0.5f * PATCH_RESOLUTION * PATCH_SIZE;
+    if (!g_app.patchGridDirty && origin == g_app.patchOrigin)
+        return;
 
-        g_app.tileIndexCount = numIndices;
+    for (uint32_t y = 0u; y < corners; ++y)
+    {
+        for (uint32_t x = 0u; x < corners; ++x)
+        {
+            const glm::vec2 corner = origin + glm::vec2(float(x), float(y)) * PATCH_SIZE;
+            PatchVertex& vertex = g_app.patchVertices[y * corners + x];
+            vertex.position[0] = corner.x;
+            vertex.position[1] = corner.y;
+
+            // The patches around a corner span one patch to either side of it
+            const HeightRange range = g_app.heightBounds.query(
+                static_cast<int32_t>(corner.x - PATCH_SIZE - PATCH_BOUNDS_PAD),
+                static_cast<int32_t>(corner.y - PATCH_SIZE - PATCH_BOUNDS_PAD),
+                static_cast<int32_t>(corner.x + PATCH_SIZE + PATCH_BOUNDS_PAD) + 1,
+                static_cast<int32_t>(corner.y + PATCH_SIZE + PATCH_BOUNDS_PAD) + 1);
+            vertex.heightRange[0] = range.min * HEIGHT_SCALE;
+            vertex.heightRange[1] = range.max * HEIGHT_SCALE;
+        }
     }
+
+    g_gl.buffers[BUFFER_VERTEX_PATCH].subData(0u, sizeof(PatchVertex) * PATCH_VERTEX_COUNT, g_app.patchVertices.data());
+
+    g_app.patchOrigin = origin;
+    g_app.patchGridDirty = false;
+}
+
+/**
+ * @brief Draws the patch grid, each edge tessellated until the height variation
+ * a segment can hide projects below TESSELLATION_ERROR_PIXELS, and displaced
+ * from the clipmap levels.
+ */
+void drawTerrainTessellated()
+{
+    updatePatchGrid();
+
+    g_gl.state.useProgram(g_gl.programs[PROGRAM_TESSELLATION]);
+    g_gl.state.bindTexture(0u, g_gl.textures[TEXTURE_CLIPMAP]);
+    g_gl.state.bindTexture(1u, g_gl.textures[TEXTURE_CLIPMAP_NORMALS]);
+
+    glPatchParameteri(GL_PATCH_VERTICES, 4);
+    g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_PATCH]);
+    glDrawElements(GL_PATCHES, 4 * PATCH_RESOLUTION * PATCH_RESOLUTION, GL_UNSIGNED_SHORT, nullptr);
+}
+
+/**
+ * @brief Selects the CDLOD quadtree against the frustum and draws whole nodes
+ * and quarters with one instanced draw each.
+ */
+void drawTerrainCdlod()
+{
+    const glm::mat4& projection = g_camera.camera.getProjection();
+    CdlodSelection& selection = g_app.cdlodSelection;
+
+    const auto start = std::chrono::steady_clock::now();
+    g_app.cdlodTree.select(g_app.heightBounds, extractFrustum(projection * g_camera.view), g_camera.pos, selection);
+    g_app.cdlodSelectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t nodeCount = selection.nodes.size();
+    const size_t quarterCount = selection.quarters.size();
+    if (nodeCount + quarterCount == 0u)
+        return;
+
+    // Nodes then quarters, addressed by baseInstance
+    const FrameAllocation instanceData = g_app.frameRing.allocate(sizeof(TileInstance) * (nodeCount + quarterCount),
+                                                                  sizeof(TileInstance));
+    TileInstance* instances = reinterpret_cast<TileInstance*>(instanceData.data);
+    std::copy(selection.nodes.begin(), selection.nodes.end(), instances);
+    std::copy(selection.quarters.begin(), selection.quarters.end(), instances + nodeCount);
+    const GLuint firstInstance = static_cast<GLuint>(instanceData.offset / sizeof(TileInstance));
+
+    g_gl.state.useProgram(g_gl.programs[PROGRAM_CDLOD]);
+    g_gl.state.bindTexture(0u, g_gl.textures[TEXTURE_CLIPMAP]);
+    g_gl.state.bindTexture(1u, g_gl.textures[TEXTURE_CLIPMAP_NORMALS]);
+
+    g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_CDLOD]);
+    const TileMesh& node = g_app.tileMeshes[MESH_TILE];
+    if (nodeCount > 0u)
+        glDrawElementsInstancedBaseInstance(TILE_PRIMITIVE, node.indexCount, TILE_INDEX_TYPE,
+                                            reinterpret_cast<const void*>(sizeof(TileIndex) * node.firstIndex),
+                                            static_cast<GLsizei>(nodeCount), firstInstance);
+    const TileMesh& quarter = g_app.cdlodQuarterMesh;
+    if (quarterCount > 0u)
+        glDrawElementsInstancedBaseInstance(TILE_PRIMITIVE, quarter.indexCount, TILE_INDEX_TYPE,
+                                            reinterpret_cast<const void*>(sizeof(TileIndex) * quarter.firstIndex),
+                                            static_cast<GLsizei>(quarterCount), firstInstance + static_cast<GLuint>(nodeCount));
+}
+
+/**
+ * @brief Picks every frustum visible chunk's representation by the screen-space
+ * size of its error at the box's nearest point. A chunk inside a clipmap
+ * level's window stays a regular grid, of the coarsest resident level whose
+ * error is small enough; a chunk beyond every window takes the coarsest baked
+ * mesh whose error is, falling back to the finest of either.
+ */
+void selectTerrainChunks()
+{
+    const auto start = std::chrono::steady_clock::now();
+    const glm::mat4& projection = g_camera.camera.getProjection();
+    const ChunkHeader& header = g_app.chunks.header();
+    const TerrainChunks& chunks = g_app.chunks;
+
+    cullAabbs(extractFrustum(projection * g_camera.view), g_app.chunkBounds, g_app.chunkVisibility.data());
+
+    g_app.chunkInstances.clear();
+    for (std::vector<DrawElementsIndirectCommand>& commands : g_app.chunkCommands)
+        commands.clear();
+
+    // Pixels a normalized error of 1 covers at unit distance
+    const float projScale = 0.5f * g_app.framebufferHeight * projection[1][1] * HEIGHT_SCALE;
+    const AabbList& bounds = g_app.chunkBounds;
+
+    for (uint32_t chunk = 0u; chunk < chunks.chunkCount(); ++chunk)
+    {
+        if (!g_app.chunkVisibility[chunk])
+            continue;
+
+        const glm::vec3 lo { bounds.loX[chunk], bounds.loY[chunk], bounds.loZ[chunk] };
+        const glm::vec3 hi { bounds.hiX[chunk], bounds.hiY[chunk], bounds.hiZ[chunk] };
+        const float pixelsPerError = projScale / std::max(glm::length(glm::clamp(g_camera.pos, lo, hi) - g_camera.pos), 1.0f);
+        const ChunkEntry& entry = chunks.entry(chunk);
+
+        // Windows grow with the level, the first one holding the chunk resident is the finest usable grid
+        const glm::ivec2 corner { static_cast<int32_t>(lo.x), static_cast<int32_t>(lo.z) };
+        int32_t level = 0;
+        while (level < static_cast<int32_t>(CLIPMAP_LEVELS) &&
+               !g_app.clipmap.isResident(level, corner >> level, (corner + static_cast<int32_t>(header.chunkSize)) >> level))
+            ++level;
+
+        const uint32_t instance = static_cast<uint32_t>(g_app.chunkInstances.size());
+        if (level < static_cast<int32_t>(CLIPMAP_LEVELS))
+        {
+            while (level + 1 < static_cast<int32_t>(CLIPMAP_LEVELS) && entry.gridErrors[level + 1] * pixelsPerError <= CHUNK_ERROR_PIXELS)
+                ++level;
+
+            const TileMesh& grid = g_app.chunkGridMeshes[level];
+            g_app.chunkInstances.push_back({ { lo.x, lo.z }, float(1u << level), entry.minHeight });
+            g_app.chunkCommands[CHUNK_DRAW_GRID].push_back({ grid.indexCount, 1u, grid.firstIndex, 0, instance });
+        }
+        else
+        {
+            uint32_t lod = header.lodCount - 1u;
+            while (lod > 0u && chunks.mesh(chunk, lod).error * pixelsPerError > CHUNK_ERROR_PIXELS)
+                --lod;
+
+            const ChunkMesh& mesh = chunks.mesh(chunk, lod);
+            g_app.chunkInstances.push_back({ { lo.x, lo.z }, 1.0f, entry.minHeight });
+            g_app.chunkCommands[CHUNK_DRAW_MESH].push_back({ mesh.indexCount, 1u, mesh.firstIndex,
+                                                             static_cast<int32_t>(mesh.firstVertex), instance });
+        }
+    }
+
+    g_app.chunkSelectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Draws the selected chunks with one multi-draw-indirect per
+ * representation, sharing the instance buffer.
+ */
+void drawTerrainChunked()
+{
+    selectTerrainChunks();
+    if (g_app.chunkInstances.empty())
+        return;
+
+    const std::vector<DrawElementsIndirectCommand>& meshCommands = g_app.chunkCommands[CHUNK_DRAW_MESH];
+    const std::vector<DrawElementsIndirectCommand>& gridCommands = g_app.chunkCommands[CHUNK_DRAW_GRID];
+
+    // Commands index instances from zero, rebased onto where the ring put them
+    FrameRing& ring = g_app.frameRing;
+    const FrameAllocation instanceData = ring.allocate(sizeof(ChunkInstance) * g_app.chunkInstances.size(),
+                                                       sizeof(ChunkInstance));
+    const FrameAllocation commandData = ring.allocate(
+        sizeof(DrawElementsIndirectCommand) * (meshCommands.size() + gridCommands.size()), alignof(DrawElementsIndirectCommand));
+    std::copy(g_app.chunkInstances.begin(), g_app.chunkInstances.end(), reinterpret_cast<ChunkInstance*>(instanceData.data));
+
+    const uint32_t firstInstance = static_cast<uint32_t>(instanceData.offset / sizeof(ChunkInstance));
+    DrawElementsIndirectCommand* commands = reinterpret_cast<DrawElementsIndirectCommand*>(commandData.data);
+    for (const std::vector<DrawElementsIndirectCommand>* group : { &meshCommands, &gridCommands })
+    {
+        for (DrawElementsIndirectCommand command : *group)
+        {
+            command.baseInstance += firstInstance;
+            *commands++ = command;
+        }
+    }
+
+    g_gl.state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, ring.getBuffer());
+
+    g_gl.state.useProgram(g_gl.programs[PROGRAM_CHUNK]);
+    g_gl.state.bindTexture(0u, g_gl.textures[TEXTURE_CLIPMAP]);
+    g_gl.state.bindTexture(1u, g_gl.textures[TEXTURE_CLIPMAP_NORMALS]);
+
+    if (!meshCommands.empty())
+    {
+        g_gl.uniforms.chunkClipmapGrid.set(false);
+        g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_CHUNK]);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(commandData.offset),
+                                    static_cast<GLsizei>(meshCommands.size()), 0);
+    }
+    if (!gridCommands.empty())
+    {
+        g_gl.uniforms.chunkClipmapGrid.set(true);
+        g_gl.state.bindVertexArray(g_gl.vertexArrays[VERTEXARRAY_CHUNK_GRID]);
+        glMultiDrawElementsIndirect(TILE_PRIMITIVE, GL_UNSIGNED_INT,
+                                    reinterpret_cast<const void*>(commandData.offset +
+                                                                  sizeof(DrawElementsIndirectCommand) * meshCommands.size()),
+                                    static_cast<GLsizei>(gridCommands.size()), 0);
+    }
+}
+
+void drawTerrainClipmap()
+{
+    g_gl.state.useProgram(g_gl.programs[PROGRAM_DEFAULT]);
+    g_gl.state.bindTexture(0u, g_gl.textures[TEXTURE_CLIPMAP]);
+    g_gl.state.bindTexture(1u, g_gl.textures[TEXTURE_CLIPMAP_NORMALS]);
+
+    // g_gl.state.polygonMode(GL_LINE);
+
+    if (g_app.renderMode == RENDER_MODE_OCCLUSION)
+        drawTilesOcclusionCulled();
+    else if (g_app.renderMode == RENDER_MODE_INDIRECT)
+        drawTilesIndirect();
+    else
+        drawTilesInstanced();
+}
+
+/**
+ * @brief Writes the camera data every terrain program reads from the
+ * FrameUniforms block into the frame ring and binds it there.
+ */
+void updateFrameUniforms()
+{
+    const glm::mat4& projection = g_camera.camera.getProjection();
+    const Frustum frustum = extractFrustum(projection * g_camera.view);
+    const FrameAllocation allocation = g_app.frameRing.allocateUniform(sizeof(FrameUniforms));
+
+    FrameUniforms* frame = reinterpret_cast<FrameUniforms*>(allocation.data);
+    frame->projMatrix = projection;
+    frame->viewMatrix = g_camera.view;
+    frame->cameraPos = g_camera.pos;
+    frame->projScale = 0.5f * g_app.framebufferHeight * projection[1][1];
+    frame->samplerDim = g_app.heightMapDim;
+    frame->finestLevel = static_cast<int32_t>(g_app.clipmap.finestResidentLevel(CLIPMAP_FOOTPRINT));
+    std::copy(std::begin(frustum.planes), std::end(frustum.planes), frame->frustumPlanes);
+
+    g_gl.state.bindBufferRange(GL_UNIFORM_BUFFER, UNIFORM_BINDING_FRAME, g_app.frameRing.getBuffer(), allocation.offset,
+                               sizeof(FrameUniforms));
 }
 
 void render()
 {
+    g_app.frameRing.beginFrame();
+    g_app.clipmap.update(g_camera.pos);
+    updateFrameUniforms();
+    if (g_app.heightBounds.applyPending() > 0u)
+        g_app.patchGridDirty = true;
+
+    const bool clipmapRenderer = g_app.renderer == RENDERER_CLIPMAP;
+    if (clipmapRenderer)
+    {
+        buildClipmapLayout(g_camera.pos, TILE_DIM, CLIPMAP_LEVELS, g_app.tileInstances);
+        cullClipmapLayout();
+
+        if (g_app.renderMode == RENDER_MODE_OCCLUSION)
+            dispatchOcclusionCulling();
+    }
+
+    g_gl.state.bindFramebuffer(GL_FRAMEBUFFER, g_gl.framebuffers[FRAMEBUFFER_SCENE]);
     glClearColor(0.12f, 0.68f, 0.87f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(g_gl.programs[PROGRAM_DEFAULT]);
-    // glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, g_gl.textures[TEXTURE_HEIGHTMAP]);
-
-    set_uni_mat4(g_gl.programs[PROGRAM_DEFAULT], "u_projMatrix", g_camera.camera.getProjection());
-    set_uni_mat4(g_gl.programs[PROGRAM_DEFAULT], "u_viewMatrix", g_camera.view);
-    set_uni_vec2(g_gl.programs[PROGRAM_DEFAULT], "u_samplerDim", g_app.heightMapDim);
+    if (clipmapRenderer)
+        drawTerrainClipmap();
+    else if (g_app.renderer == RENDERER_CDLOD)
+        drawTerrainCdlod();
+    else if (g_app.renderer == RENDERER_CHUNKED)
+        drawTerrainChunked();
+    else
+        drawTerrainTessellated();
 
-    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    if (clipmapRenderer && g_app.renderMode == RENDER_MODE_OCCLUSION)
+        buildHiZ(g_camera.camera.getProjection() * g_camera.view);
 
-    const GLenum drawMode = GL_TRIANGLE_STRIP;
-    static constexpr float tileDim = static_cast<float>(TILE_DIM);
+    g_gl.state.bindFramebuffer(GL_READ_FRAMEBUFFER, g_gl.framebuffers[FRAMEBUFFER_SCENE]);
+    g_gl.state.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0u);
+    glBlitFramebuffer(0, 0, g_app.framebufferWidth, g_app.framebufferHeight,
+                      0, 0, g_app.framebufferWidth, g_app.framebufferHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-    auto renderTile = [drawMode](glm::vec2 translation, float scale) {
-        const float expScale = scale / tileDim;
-        glm::vec3 snapped_pos = glm::floor(g_camera.pos / expScale) * expScale;
+    g_app.frameRing.endFrame();
+}
 
-        glm::mat4 transform { 1.0f };
-        transform = glm::translate(transform, { translation.x, 0.0f, translation.y });
-        // transform = glm::translate(transform, { g_camera.pos.x, 0.0f, g_camera.pos.z });
-        transform = glm::translate(transform, { snapped_pos.x, 0.0f, snapped_pos.z });
-        transform = glm::scale(transform, { scale, 1.0f, scale });
-        set_uni_mat4(g_gl.programs[PROGRAM_DEFAULT], "u_modelMatrix", transform);
+/**
+ * @brief Puts the camera at a point of the benchmark path, a circle around the
+ * map center looking along the path and slightly down.
+ */
+void setBenchmarkCamera(uint32_t frame)
+{
+    const float angle = glm::radians(360.0f) * static_cast<float>(frame) / BENCHMARK_FRAMES;
+    const glm::vec2 center = 0.5f * g_app.heightMapDim;
+    const float radius = 0.25f * std::min(g_app.heightMapDim.x, g_app.heightMapDim.y);
 
-        glBindVertexArray(g_gl.vertexArrays[VERTEXARRAY_TILE]);
-        // glDrawElements(GL_TRIANGLE_STRIP, g_app.tileIndexCount, GL_UNSIGNED_INT, nullptr);
-        glDrawElements(GL_TRIANGLES, g_app.tileIndexCount, GL_UNSIGNED_INT, nullptr);
-    };
+    g_camera.pos = { center.x + radius * glm::cos(angle), 2.0f * HEIGHT_SCALE, center.y + radius * glm::sin(angle) };
+    g_camera.forward = glm::normalize(glm::vec3(-glm::sin(angle), -0.3f, glm::cos(angle)));
+    updateCameraMatrix();
+}
 
-    // Center Tiles
-    renderTile({0,0}, tileDim);
-    renderTile({0,-tileDim}, tileDim);
-    renderTile({-tileDim,-tileDim}, tileDim);
-    renderTile({-tileDim, 0}, tileDim);
+/**
+ * @brief Flies every renderer along the same camera path and logs its mean GPU
+ * time, CPU submission time and primitive count per frame. A first, unmeasured
+ * lap streams the path's tiles in so every renderer sees the same resident data.
+ */
+void runBenchmark(GLFWwindow* window)
+{
+    glfwSwapInterval(0);
+    GLuint queries[2];
+    glGenQueries(2, queries);
 
-    // Rings
-    for (uint32_t level = 0u, scale = 1u; level < CLIPMAP_LEVELS; ++level, scale *= 2u)
+    for (int32_t lap = -1; lap < static_cast<int32_t>(RENDERER_COUNT); ++lap)
     {
-        float dim = (1<<level) * tileDim;
+        g_app.renderer = lap < 0 ? static_cast<uint32_t>(RENDERER_CLIPMAP) : static_cast<uint32_t>(lap);
+        g_app.patchGridDirty = true;
+
+        double gpuMs = 0.0;
+        double cpuMs = 0.0;
+        uint64_t primitives = 0u;
+        g_gl.state.resetStats();
+        for (uint32_t frame = 0u; frame < BENCHMARK_FRAMES && !glfwWindowShouldClose(window); ++frame)
+        {
+            setBenchmarkCamera(frame);
+
+            const auto start = std::chrono::steady_clock::now();
+            glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+            glBeginQuery(GL_PRIMITIVES_GENERATED, queries[1]);
+            render();
+            glEndQuery(GL_PRIMITIVES_GENERATED);
+            glEndQuery(GL_TIME_ELAPSED);
+            cpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            // Waits for the frame, the benchmark trades overlap for exact numbers
+            GLuint64 elapsed = 0u;
+            GLuint64 generated = 0u;
+            glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &elapsed);
+            glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &generated);
+            gpuMs += elapsed * 1e-6;
+            primitives += generated;
+        }
 
-        // Top
-        renderTile({0.0f, dim}, dim);
-        renderTile({dim, dim}, dim);
+        const GLState::Stats& state = g_gl.state.getStats();
+        if (lap >= 0)
+        {
+            LOG("Benchmark %-12s: %u frames, GPU %.3f ms, CPU %.3f ms, %.0f primitives, %.1f / %.1f state changes "
+                "issued / elided per frame\n", RENDERER_NAMES[lap], BENCHMARK_FRAMES, gpuMs / BENCHMARK_FRAMES,
+                cpuMs / BENCHMARK_FRAMES, double(primitives) / BENCHMARK_FRAMES,
+                double(state.issued) / BENCHMARK_FRAMES, double(state.elided) / BENCHMARK_FRAMES);
+        }
+    }
 
-        // Right
-        renderTile({dim, 0.0f}, dim);
-        renderTile({dim, -dim}, dim);
+    glDeleteQueries(2, queries);
+}
 
-        // Bot
-        renderTile({dim, -2.0f*dim}, dim);
-        renderTile({0.0f, -2.0f*dim}, dim);
-        renderTile({-dim, -2.0f*dim}, dim);
-        renderTile({-2.0f*dim, -2.0f*dim}, dim);
+void logStreamingStats()
+{
+    const TileDecodePool::Stats stats = g_app.clipmap.getDecodeStats();
+    LOG("Streaming: queue %zu, in flight %zu, decoded %llu, cancelled %llu, request latency p50 %.2f p95 %.2f p99 %.2f ms\n",
+        stats.queueDepth, stats.inFlight,
+        static_cast<unsigned long long>(stats.completed), static_cast<unsigned long long>(stats.cancelled),
+        stats.latencyP50Ms, stats.latencyP95Ms, stats.latencyP99Ms);
+    LOG("Clipmap: %.1f KiB uploaded last frame, %zu pieces deferred, finest resident level %u\n",
+        g_app.clipmap.getFrameUploadBytes() / 1024.0, g_app.clipmap.getDeferredPieces(),
+        g_app.clipmap.finestResidentLevel(CLIPMAP_FOOTPRINT));
+
+    const TileCache::Stats cache = g_app.tileCache.getStats();
+    const uint64_t lookups = cache.hits + cache.misses;
+    LOG("Tile cache: %.1f / %.1f MiB, %zu tiles (%zu pinned), hits %llu, misses %llu (%.1f%% hit rate), evictions %llu\n",
+        cache.residentBytes / 1048576.0, TILE_CACHE_BUDGET / 1048576.0, cache.residentTiles, cache.pinnedTiles,
+        static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.misses),
+        lookups ? 100.0 * cache.hits / lookups : 0.0, static_cast<unsigned long long>(cache.evictions));
+
+    const FrameRing& ring = g_app.frameRing;
+    LOG("Frame ring: peak %.1f / %.1f KiB per region, %u regions\n", ring.getPeakUsage() / 1024.0,
+        ring.getRegionSize() / 1024.0, ring.getRegionCount());
+}
 
-        // Left
-        renderTile({-2.0f*dim, -dim}, dim);
-        renderTile({-2.0f*dim, 0.0f}, dim);
+void logCullingStats()
+{
+    CullStats& stats = g_app.cullStats;
+    if (stats.frames == 0u)
+        return;
 
-        // Top
-        renderTile({-2.0f*dim, dim}, dim);
-        renderTile({-dim, dim}, dim);
+    const uint64_t total = stats.visibleTotal + stats.culledTotal;
+    LOG("Culling: last frame %u visible, %u culled; %.1f visible / %.1f culled per frame (%.1f%% culled), %.3f ms\n",
+        stats.visible, stats.culled, double(stats.visibleTotal) / stats.frames, double(stats.culledTotal) / stats.frames,
+        total ? 100.0 * stats.culledTotal / total : 0.0, stats.cullMs / stats.frames);
+
+    if (g_app.renderer == RENDERER_CLIPMAP && g_app.renderMode == RENDER_MODE_OCCLUSION)
+    {
+        // Waits for the last frame's culling pass, once per report. Its commands
+        // stay in the frame ring until that region comes around again
+        DrawElementsIndirectCommand commands[MESH_COUNT];
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        g_gl.buffers[BUFFER_FRAME_RING].getSubData(g_app.cullCommandsOffset, sizeof(commands), commands);
+
+        uint32_t drawn = 0u;
+        for (const DrawElementsIndirectCommand& command : commands)
+            drawn += command.instanceCount;
+        LOG("Occlusion: last frame %u of %zu frustum visible instances drawn\n", drawn, g_app.cullCandidates.size());
     }
 
-    glUseProgram(0u);
+    stats.visibleTotal = 0u;
+    stats.culledTotal = 0u;
+    stats.frames = 0u;
+    stats.cullMs = 0.0;
+}
+
+void logStateStats(uint64_t frames)
+{
+    const GLState::Stats& stats = g_gl.state.getStats();
+    const uint64_t total = stats.issued + stats.elided;
+    if (frames == 0u || total == 0u)
+        return;
+
+    LOG("GL state: %.1f issued, %.1f elided per frame (%.1f%% elided)\n", double(stats.issued) / frames,
+        double(stats.elided) / frames, 100.0 * stats.elided / total);
+    g_gl.state.resetStats();
+}
+
+void logCdlodStats()
+{
+    const CdlodSelection& selection = g_app.cdlodSelection;
+    LOG("CDLOD: last frame %zu nodes, %zu quarters, %u visited of %u roots, select %.3f ms\n",
+        selection.nodes.size(), selection.quarters.size(), selection.visitedNodes, g_app.cdlodTree.getRootCount(),
+        g_app.cdlodSelectMs);
+}
+
+void logChunkStats()
+{
+    const std::vector<DrawElementsIndirectCommand>& meshCommands = g_app.chunkCommands[CHUNK_DRAW_MESH];
+    const std::vector<DrawElementsIndirectCommand>& gridCommands = g_app.chunkCommands[CHUNK_DRAW_GRID];
+
+    uint64_t meshTriangles = 0u;
+    for (const DrawElementsIndirectCommand& command : meshCommands)
+        meshTriangles += command.count / 3u;
+
+    LOG("Chunks: last frame %zu grids, %zu meshes (%llu triangles) of %u chunks, select %.3f ms\n",
+        gridCommands.size(), meshCommands.size(), static_cast<unsigned long long>(meshTriangles),
+        g_app.chunks.chunkCount(), g_app.chunkSelectMs);
 }
 
 void release()
 {
-    glDeleteBuffers(BUFFER_COUNT, g_gl.buffers);
-    glDeleteVertexArrays(VERTEXARRAY_COUNT, g_gl.vertexArrays);
-    glDeleteTextures(TEXTURE_COUNT, g_gl.textures);
-    glDeleteProgram(g_gl.programs[PROGRAM_DEFAULT]);
+    g_app.frameRing.destroy();
+    g_app.clipmap.destroy();
+    g_app.tileCache.clear();
+
+    // g_gl outlives the context, so its objects are deleted here rather than by their destructors
+    for (Buffer& buffer : g_gl.buffers)
+        buffer.destroy();
+    for (VertexArray& vertexArray : g_gl.vertexArrays)
+        vertexArray.destroy();
+    for (Texture& texture : g_gl.textures)
+        texture.destroy();
+    for (Framebuffer& framebuffer : g_gl.framebuffers)
+        framebuffer.destroy();
+    for (ShaderProgram& program : g_gl.programs)
+        program.destroy();
+
+    g_app.chunks.close();
+    g_app.pyramid.close();
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    bool benchmark = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--tessellation")
+            g_app.renderer = RENDERER_TESSELLATION;
+        else if (arg == "--cdlod")
+            g_app.renderer = RENDERER_CDLOD;
+        else if (arg == "--chunked")
+            g_app.renderer = RENDERER_CHUNKED;
+        else if (arg == "--benchmark")
+            benchmark = true;
+        else
+        {
+            LOG("Unknown argument %s (expected --tessellation, --cdlod, --chunked, --benchmark)\n", argv[i]);
+        }
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
@@ -463,6 +1569,7 @@ int main()
     glfwMakeContextCurrent(window);
     glfwSetCursorPosCallback(window, &cursorPosCallback);
     glfwSetScrollCallback(window, &mouseScrollCallback);
+    glfwSetKeyCallback(window, &keyCallback);
 
     // Load OpenGL functions
     LOG("Loading {OpenGL}\n");
@@ -477,14 +1584,40 @@ int main()
     init();
     LOG("-- End -- Init\n");
 
-    glEnable(GL_DEPTH_TEST);
+    g_gl.state.setEnabled(GL_DEPTH_TEST, true);
+    g_gl.state.setEnabled(GL_PRIMITIVE_RESTART_FIXED_INDEX, true);
+
+    if (benchmark)
+    {
+        runBenchmark(window);
+        release();
+        return 0;
+    }
+
+    LOG("Renderer: %s\n", RENDERER_NAMES[g_app.renderer]);
+
+    double statsTime = glfwGetTime();
+    uint64_t statsFrames = 0u;
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
 
         render();
+        ++statsFrames;
 
         glfwSwapBuffers(window);
+
+        if (glfwGetTime() - statsTime > 5.0) {
+            logStreamingStats();
+            logCullingStats();
+            logStateStats(statsFrames);
+            if (g_app.renderer == RENDERER_CDLOD)
+                logCdlodStats();
+            else if (g_app.renderer == RENDERER_CHUNKED)
+                logChunkStats();
+            statsTime = glfwGetTime();
+            statsFrames = 0u;
+        }
     }
 
     release();
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <chrono>
+
+#include "Defines.hpp"
+#include "TileIndices.hpp"
+
+/**
+ * @brief Prints the average cache miss ratio (vertex shader invocations per
+ * triangle, 0.5 at best for a grid) of every tile index ordering for a range of
+ * TILE_DIM values and post-transform cache sizes.
+ */
+int main()
+{
+    const uint32_t dims[] = { 8u, 16u, 32u, 64u, 128u, 256u };
+    const uint32_t cacheSizes[] = { 16u, 32u };
+
+    LOG("%8s %6s %10s %10s %10s %12s %12s\n", "TILE_DIM", "cache", "rows", "tipsify", "row strips", "block strips",
+        "tipsify ms");
+
+    for (uint32_t dim : dims)
+    {
+        const uint32_t vertexCount = (dim + 1u) * (dim + 1u);
+        const std::vector<uint32_t> rows = buildGridTriangles(dim, dim, dim + 1u);
+        const std::vector<uint32_t> rowStrips = buildGridStrips(dim, dim, dim + 1u, dim);
+
+        for (uint32_t cacheSize : cacheSizes)
+        {
+            std::vector<uint32_t> tipsify = rows;
+            const auto start = std::chrono::steady_clock::now();
+            optimizeVertexCache(tipsify, vertexCount, cacheSize);
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+            const std::vector<uint32_t> blockStrips = buildGridStrips(dim, dim, dim + 1u, gridStripBlockWidth(cacheSize));
+
+            LOG("%8u %6u %10.3f %10.3f %10.3f %12.3f %12.2f\n", dim, cacheSize,
+                simulateVertexCache(rows, false, cacheSize).acmr(),
+                simulateVertexCache(tipsify, false, cacheSize).acmr(),
+                simulateVertexCache(rowStrips, true, cacheSize).acmr(),
+                simulateVertexCache(blockStrips, true, cacheSize).acmr(),
+                elapsed.count());
+        }
+    }
+
+    return 0;
+}
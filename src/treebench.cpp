@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "Defines.hpp"
+#include "MinMaxTree.hpp"
+#include "Parallel.hpp"
+
+constexpr uint32_t RUNS = 5u; // builds per map size, the fastest is reported
+
+/**
+ * @brief Prints the time MinMaxTree::build takes over synthetic 16-bit
+ * heightmaps from 1k x 1k to 8k x 8k, the fastest of RUNS builds each.
+ */
+int main()
+{
+    const uint32_t dims[] = { 1024u, 2048u, 4096u, 8192u };
+
+    LOG("MinMaxTree::build, %u thread(s), CELL_DIM %u\n", hardwareThreadCount(), MinMaxTree::CELL_DIM);
+    LOG("%10s %8s %12s %10s\n", "map", "levels", "build ms", "GB/s");
+
+    for (uint32_t dim : dims)
+    {
+        // Hashed samples, so no cell is flat and every comparison counts
+        std::vector<uint16_t> samples(size_t(dim) * dim);
+        uint32_t state = 0x9e3779b9u;
+        for (uint16_t& sample : samples)
+        {
+            state ^= state << 13u;
+            state ^= state >> 17u;
+            state ^= state << 5u;
+            sample = static_cast<uint16_t>(state);
+        }
+
+        const HeightImage image { PYRAMID_FORMAT_R16, dim, dim, samples.data() };
+        MinMaxTree tree;
+        double bestMs = 0.0;
+        for (uint32_t run = 0u; run < RUNS; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            tree.build(image);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            bestMs = run == 0u ? ms : std::min(bestMs, ms);
+        }
+
+        LOG("%5u x %-4u %8u %12.2f %10.2f\n", dim, dim, tree.getLevelCount(), bestMs,
+            samples.size() * sizeof(uint16_t) / (bestMs * 1e6));
+    }
+
+    return 0;
+}